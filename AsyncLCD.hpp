@@ -0,0 +1,220 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Scheduler.hpp>
+#include <Clock.hpp>
+#include <ILCD.h>
+
+/*
+AsyncLCD wraps a blocking ILCD driver so screen updates don't hold up the
+schedule.  Text and commands go into a bounded queue and return at once; a
+scheduled pump sends at most bytesPerPoll of them to the real display each
+loop.  After clear() or home() the pump leaves the display alone for
+clearMs, timed with a Timer instead of delay(), while everything else keeps
+polling.
+
+It's an ILCD itself, so MainDisplay and friends use it unchanged:
+
+MainSchedule schedule;
+LK204_25_LCD lcd;
+AsyncLCD<> asyncLcd(schedule, lcd);
+MainDisplay<AsyncLCD<>, 4, 20> display(schedule, asyncLcd, renderer, 125);
+
+If the queue fills up, the caller waits while it drains, rather than losing
+output that MainDisplay thinks has been sent.  stalls() counts how often
+that happened; size the queue (TQueueSize bytes) so it stays at 0.  begin()
+is passed straight through, and drain() sends everything now.
+*/
+template <int TQueueSize = 128>
+class AsyncLCD : public ILCD, private Scheduled {
+	// Text is queued as-is.  Escape starts a command; a literal Escape
+	// character is queued twice.
+	static const uint8_t Escape = 0xFF;
+	enum Op {
+		Op_Clear = 1, Op_Home, Op_NoDisplay, Op_Display, Op_NoBlink, Op_Blink,
+		Op_NoCursor, Op_Cursor, Op_ScrollLeft, Op_ScrollRight, Op_LeftToRight,
+		Op_RightToLeft, Op_NoBacklight, Op_Backlight, Op_Autoscroll,
+		Op_NoAutoscroll, Op_SetCursor, Op_CreateChar
+	};
+	ILCD &_lcd;
+	uint8_t _queue[TQueueSize];
+	int _head;
+	int _count;
+	int _bytesPerPoll;
+	long _clearMs;
+	Timer _hold;
+	bool _holding;
+	bool _backlight;
+	uint16_t _stalls;
+public:
+	AsyncLCD(Schedule &schedule, ILCD &lcd, int bytesPerPoll = 24, long clearMs = 2) :
+		Scheduled(schedule), _lcd(lcd), _head(0), _count(0), _bytesPerPoll(bytesPerPoll),
+		_clearMs(clearMs), _holding(false), _backlight(true), _stalls(0) { }
+	void poll() override { pump(_bytesPerPoll); }
+
+	void begin() { _lcd.begin(); }
+	void clear() { command(Op_Clear); }
+	void home() { command(Op_Home); }
+	void noDisplay() { command(Op_NoDisplay); }
+	void display() { command(Op_Display); }
+	void noBlink() { command(Op_NoBlink); }
+	void blink() { command(Op_Blink); }
+	void noCursor() { command(Op_NoCursor); }
+	void cursor() { command(Op_Cursor); }
+	void scrollDisplayLeft() { command(Op_ScrollLeft); }
+	void scrollDisplayRight() { command(Op_ScrollRight); }
+	void leftToRight() { command(Op_LeftToRight); }
+	void rightToLeft() { command(Op_RightToLeft); }
+	void noBacklight() { _backlight = false; command(Op_NoBacklight); }
+	void backlight() { _backlight = true; command(Op_Backlight); }
+	bool getBacklight() { return _backlight; }
+	void autoscroll() { command(Op_Autoscroll); }
+	void noAutoscroll() { command(Op_NoAutoscroll); }
+	void setCursor(uint8_t col, uint8_t row) {
+		const uint8_t bytes[] = { Escape, Op_SetCursor, col, row };
+		push(bytes, sizeof(bytes));
+	}
+	void createChar(uint8_t slot, uint8_t bitmap[]) {
+		uint8_t bytes[3 + 8] = { Escape, Op_CreateChar, slot };
+		memcpy(bytes + 3, bitmap, 8);
+		push(bytes, sizeof(bytes));
+	}
+	virtual size_t write(uint8_t c) {
+		const uint8_t bytes[] = { c, c };
+		push(bytes, c == Escape ? 2 : 1);
+		return 1;
+	}
+	using Print::write;
+	// Queued output is the pump's business, so flush() doesn't wait for it.
+	virtual void flush() { }
+
+	void drain() {
+		while (_count) {
+			pump(TQueueSize);
+		}
+	}
+	bool idle() const { return _count == 0; }
+	int queued() const { return _count; }
+	uint16_t stalls() const { return _stalls; }
+private:
+	void command(Op op) {
+		const uint8_t bytes[] = { Escape, (uint8_t)op };
+		push(bytes, sizeof(bytes));
+	}
+	void push(const uint8_t *bytes, int n) {
+		if (TQueueSize - _count < n) {
+			_stalls++;
+			while (TQueueSize - _count < n) {
+				pump(TQueueSize);
+			}
+		}
+		for (int i = 0; i < n; i++) {
+			_queue[(_head + _count++) % TQueueSize] = bytes[i];
+		}
+	}
+	uint8_t peek(int i) const { return _queue[(_head + i) % TQueueSize]; }
+	void pop(int n) {
+		_head = (_head + n) % TQueueSize;
+		_count -= n;
+	}
+	bool holding() {
+		if (_holding && _hold.expired()) {
+			_holding = false;
+		}
+		return _holding;
+	}
+	// Text is handed over in runs so a batching driver (LK204_25_LCD) can
+	// send it in one go.
+	void pump(int budget) {
+		uint8_t text[24];
+		int n = 0;
+		while (budget > 0 && _count && !holding()) {
+			uint8_t b = peek(0);
+			int length = 1;
+			if (b == Escape) {
+				uint8_t op = peek(1);
+				length = op == Op_SetCursor ? 4 : op == Op_CreateChar ? 11 : 2;
+				if (op == Escape) {
+					length = 2;
+				} else {
+					if (n) {
+						_lcd.write(text, n);
+						n = 0;
+					}
+					run((Op)op);
+					pop(length);
+					budget -= length;
+					continue;
+				}
+			}
+			text[n++] = b;
+			pop(length);
+			budget -= length;
+			if (n == (int)sizeof(text)) {
+				_lcd.write(text, n);
+				n = 0;
+			}
+		}
+		if (n) {
+			_lcd.write(text, n);
+		}
+		_lcd.flush();
+	}
+	void run(Op op) {
+		switch (op) {
+			case Op_Clear: _lcd.clear(); hold(); break;
+			case Op_Home: _lcd.home(); hold(); break;
+			case Op_NoDisplay: _lcd.noDisplay(); break;
+			case Op_Display: _lcd.display(); break;
+			case Op_NoBlink: _lcd.noBlink(); break;
+			case Op_Blink: _lcd.blink(); break;
+			case Op_NoCursor: _lcd.noCursor(); break;
+			case Op_Cursor: _lcd.cursor(); break;
+			case Op_ScrollLeft: _lcd.scrollDisplayLeft(); break;
+			case Op_ScrollRight: _lcd.scrollDisplayRight(); break;
+			case Op_LeftToRight: _lcd.leftToRight(); break;
+			case Op_RightToLeft: _lcd.rightToLeft(); break;
+			case Op_NoBacklight: _lcd.noBacklight(); break;
+			case Op_Backlight: _lcd.backlight(); break;
+			case Op_Autoscroll: _lcd.autoscroll(); break;
+			case Op_NoAutoscroll: _lcd.noAutoscroll(); break;
+			case Op_SetCursor: _lcd.setCursor(peek(2), peek(3)); break;
+			case Op_CreateChar: {
+				uint8_t bitmap[8];
+				for (int i = 0; i < 8; i++) bitmap[i] = peek(3 + i);
+				_lcd.createChar(peek(2), bitmap);
+				break;
+			}
+		}
+	}
+	void hold() {
+		if (_clearMs > 0) {
+			_hold.reset(_clearMs);
+			_holding = true;
+		}
+	}
+};
@@ -0,0 +1,269 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <Scheduler.hpp>
+
+/*
+Deferred logging that is safe to call from an ISR.
+
+LOG_DEFER*() copies a timestamp, the format string pointer and up to two
+values into a fixed ring of records.  Nothing is formatted or printed at
+the call site, so a log call costs the same few microseconds whether or not
+Serial is connected.  DeferredLogPrinter drains the ring from the schedule,
+a few records per poll, and prints them as "[micros] formatted text".
+
+Formats understand %d %i %u %ld %lu %x %X %c %s %% with optional width,
+0-padding and left-justify (-).  %s must point at something that outlives
+the record (a string literal, say).  When the ring is full new records are
+dropped and counted.
+
+The ring isn't lock-free: a writer claims its slot and fills the record in a
+critical section of a few instructions (see DEFERRED_LOG_LOCK below), so
+the cost of a call is still bounded.
+
+Logging is compiled out unless DEFERRED_LOG is 1, same as DEBUG in
+Arduino.hpp:
+
+#define DEFERRED_LOG 1
+#include <DeferredLog.hpp>
+MainSchedule schedule;
+DeferredLogPrinter logPrinter(schedule);
+void isr() { LOG_DEFER1("edge at pin %d", 3); }
+void setup() {
+	Serial.begin(115200);
+	Serial.print("ns per log call: ");
+	Serial.println(DeferredLogPrinter::measure());
+	schedule.begin();
+}
+void loop() { schedule.poll(); }
+*/
+
+#ifndef DEFERRED_LOG_SIZE
+#define DEFERRED_LOG_SIZE 16 // records, power of two
+#endif
+
+#if defined(__AVR__)
+#define DEFERRED_LOG_STR(s) PSTR(s)
+#define DEFERRED_LOG_CHAR(p) ((char)pgm_read_byte(p))
+#else
+#define DEFERRED_LOG_STR(s) (s)
+#define DEFERRED_LOG_CHAR(p) (*(p))
+#endif
+
+// Writers may be an ISR and the loop at once (or both cores on ESP32), so a
+// slot is claimed inside a critical section of a handful of instructions.
+// The saved interrupt state is restored, so this is safe inside an ISR.
+#if defined(__AVR__)
+#define DEFERRED_LOG_LOCK() uint8_t _deferredLogSreg = SREG; cli()
+#define DEFERRED_LOG_UNLOCK() SREG = _deferredLogSreg
+#elif defined(ARDUINO_ARCH_ESP32)
+#define DEFERRED_LOG_LOCK() portENTER_CRITICAL_SAFE(&_DeferredLog::_mux)
+#define DEFERRED_LOG_UNLOCK() portEXIT_CRITICAL_SAFE(&_DeferredLog::_mux)
+#elif defined(__arm__)
+#define DEFERRED_LOG_LOCK() uint32_t _deferredLogPrimask = __get_PRIMASK(); __disable_irq()
+#define DEFERRED_LOG_UNLOCK() __set_PRIMASK(_deferredLogPrimask)
+#else
+#define DEFERRED_LOG_LOCK() noInterrupts()
+#define DEFERRED_LOG_UNLOCK() interrupts()
+#endif
+
+#if DEFERRED_LOG == 1
+#define LOG_DEFER(fmt) _DeferredLog::write(DEFERRED_LOG_STR(fmt), 0, 0)
+#define LOG_DEFER1(fmt, a) _DeferredLog::write(DEFERRED_LOG_STR(fmt), (long)(a), 0)
+#define LOG_DEFER2(fmt, a, b) _DeferredLog::write(DEFERRED_LOG_STR(fmt), (long)(a), (long)(b))
+#else
+#define LOG_DEFER(fmt)
+#define LOG_DEFER1(fmt, a)
+#define LOG_DEFER2(fmt, a, b)
+#endif
+
+namespace _DeferredLog {
+	struct Record {
+		unsigned long time;
+		const char *format;
+		long a;
+		long b;
+	};
+	Record _ring[DEFERRED_LOG_SIZE];
+	volatile uint8_t _head;  // next slot to write; only writers touch it
+	volatile uint8_t _tail;  // next slot to read; only the printer touches it
+	volatile uint16_t _dropped;
+#if defined(ARDUINO_ARCH_ESP32)
+	portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+	inline void write(const char *format, long a, long b) {
+		unsigned long now = micros();
+		DEFERRED_LOG_LOCK();
+		uint8_t head = _head;
+		uint8_t next = (head + 1) & (DEFERRED_LOG_SIZE - 1);
+		if (next == _tail) {
+			_dropped++;
+		} else {
+			Record &r = _ring[head];
+			r.time = now;
+			r.format = format;
+			r.a = a;
+			r.b = b;
+			_head = next;
+		}
+		DEFERRED_LOG_UNLOCK();
+	}
+
+	// Single reader, so no lock: the slot at _tail isn't reused until _tail moves.
+	inline bool read(Record &out) {
+		uint8_t tail = _tail;
+		if (tail == _head) {
+			return false;
+		}
+		out = _ring[tail];
+		_tail = (tail + 1) & (DEFERRED_LOG_SIZE - 1);
+		return true;
+	}
+
+	inline void discard() {
+		_tail = _head;
+	}
+}
+
+class DeferredLogPrinter : private Scheduled {
+	Print &_out;
+	uint8_t _recordsPerPoll;
+	uint16_t _reportedDropped;
+public:
+	DeferredLogPrinter(Schedule &schedule, Print &out = Serial, uint8_t recordsPerPoll = 2) :
+		Scheduled(schedule), _out(out), _recordsPerPoll(recordsPerPoll), _reportedDropped(0) { }
+	void poll() {
+		_DeferredLog::Record r;
+		for (uint8_t i = 0; i < _recordsPerPoll && _DeferredLog::read(r); i++) {
+			print(_out, r);
+		}
+		uint16_t dropped = _DeferredLog::_dropped;
+		if (dropped != _reportedDropped) {
+			_out.print("[log] dropped ");
+			_out.println((uint16_t)(dropped - _reportedDropped));
+			_reportedDropped = dropped;
+		}
+	}
+
+	// Average cost of one log call in nanoseconds, timed over a burst that
+	// fits in the ring.  The records are thrown away afterwards.
+	static unsigned long measure(uint8_t bursts = 8) {
+		const uint8_t perBurst = DEFERRED_LOG_SIZE - 1;
+		unsigned long total = 0;
+		for (uint8_t i = 0; i < bursts; i++) {
+			_DeferredLog::discard();
+			unsigned long start = micros();
+			for (uint8_t j = 0; j < perBurst; j++) {
+				_DeferredLog::write(DEFERRED_LOG_STR("measure %d %d"), i, j);
+			}
+			total += micros() - start;
+		}
+		_DeferredLog::discard();
+		return total * 1000UL / ((unsigned long)bursts * perBurst);
+	}
+
+	static void print(Print &out, const _DeferredLog::Record &r) {
+		out.print('[');
+		out.print(r.time);
+		out.print("] ");
+		long args[2] = { r.a, r.b };
+		int next = 0;
+		const char *p = r.format;
+		for (char ch = DEFERRED_LOG_CHAR(p); ch; ch = DEFERRED_LOG_CHAR(++p)) {
+			if (ch != '%') {
+				out.print(ch);
+				continue;
+			}
+			ch = DEFERRED_LOG_CHAR(++p);
+			if (ch == '%') {
+				out.print('%');
+				continue;
+			}
+			bool left = ch == '-';
+			if (left) {
+				ch = DEFERRED_LOG_CHAR(++p);
+			}
+			char pad = ' ';
+			if (ch == '0' && !left) {
+				pad = '0';
+				ch = DEFERRED_LOG_CHAR(++p);
+			}
+			int width = 0;
+			while (ch >= '0' && ch <= '9') {
+				width = width * 10 + (ch - '0');
+				ch = DEFERRED_LOG_CHAR(++p);
+			}
+			while (ch == 'l' || ch == 'h') {
+				ch = DEFERRED_LOG_CHAR(++p);
+			}
+			if (!ch) {
+				break;
+			}
+			long value = next < 2 ? args[next++] : 0;
+			switch (ch) {
+				case 'd': case 'i': printNumber(out, value, 10, true, left ? -width : width, pad); break;
+				case 'u': printNumber(out, value, 10, false, left ? -width : width, pad); break;
+				case 'x': printNumber(out, value, 16, false, left ? -width : width, pad, 'a'); break;
+				case 'X': printNumber(out, value, 16, false, left ? -width : width, pad); break;
+				case 'c': out.print((char)value); break;
+				case 's': out.print(value ? (const char *)(uintptr_t)value : "(null)"); break;
+				default: out.print(ch); break;
+			}
+		}
+		out.println();
+	}
+private:
+	// A negative width left-justifies.
+	static void printNumber(Print &out, long value, uint8_t base, bool isSigned, int width, char pad, char hexA = 'A') {
+		char digits[12];
+		int n = 0;
+		bool negative = isSigned && value < 0;
+		unsigned long v = negative ? -(unsigned long)value : (unsigned long)value;
+		do {
+			uint8_t d = v % base;
+			digits[n++] = d < 10 ? '0' + d : hexA + d - 10;
+			v /= base;
+		} while (v && n < (int)sizeof(digits));
+		int len = n + (negative ? 1 : 0);
+		int trailing = width < 0 ? -width - len : 0;
+		if (negative && pad == '0') {
+			out.print('-');
+		}
+		for (; width > len; width--) {
+			out.print(pad);
+		}
+		if (negative && pad != '0') {
+			out.print('-');
+		}
+		while (n > 0) {
+			out.print(digits[--n]);
+		}
+		for (; trailing > 0; trailing--) {
+			out.print(' ');
+		}
+	}
+};
@@ -26,28 +26,118 @@ SOFTWARE.
 
 #include <Scheduler.hpp>
 #include <Clock.hpp>
+#include <Format.hpp>
 #include <string.h>
-#include <stdio.h>
 
+// Per row, the span of columns that changed since the last clear().
+template <int TRows, int TCols>
+class DirtySpans {
+	uint8_t _from[TRows];
+	uint8_t _to[TRows];
+public:
+	DirtySpans() { clear(); }
+	void mark(int row, int col) {
+		if (col < _from[row]) _from[row] = col;
+		if (col >= _to[row]) _to[row] = col + 1;
+	}
+	void merge(const DirtySpans &other) {
+		for (int r = 0; r < TRows; r++) {
+			if (!other.dirty(r)) continue;
+			if (other._from[r] < _from[r]) _from[r] = other._from[r];
+			if (other._to[r] > _to[r]) _to[r] = other._to[r];
+		}
+	}
+	bool dirty() const {
+		for (int r = 0; r < TRows; r++) {
+			if (dirty(r)) return true;
+		}
+		return false;
+	}
+	bool dirty(int row) const { return _from[row] < _to[row]; }
+	// Changed columns of a row are in [from, to).
+	int from(int row) const { return _from[row]; }
+	int to(int row) const { return _to[row]; }
+	void clear() {
+		for (int r = 0; r < TRows; r++) {
+			_from[r] = TCols;
+			_to[r] = 0;
+		}
+	}
+};
+
+// Keeps, per row, the span of columns whose contents changed since the
+// last markClean(), so a flush only has to look there.
+//
+// A whole frame can be redrawn from scratch between beginFrame() and
+// endFrame() without every drawn cell looking changed: inside a frame,
+// clear() doesn't touch the contents, it only forgets which cells were
+// drawn, and endFrame() fills the cells nothing drew since.  So only cells
+// that end the frame different from how they started it are dirty.
 template <int TRows, int TCols>
 class DisplayBuffer {
 	char _data[TRows][TCols];
+	DirtySpans<TRows, TCols> _dirty;
+	uint8_t _drawn[(TRows * TCols + 7) / 8]; // cells set this frame
+	bool _inFrame;
+	char _frameFill;
+	void drawn(int row, int col) {
+		int i = row * TCols + col;
+		_drawn[i >> 3] |= 1 << (i & 7);
+	}
+	bool wasDrawn(int row, int col) const {
+		int i = row * TCols + col;
+		return _drawn[i >> 3] & (1 << (i & 7));
+	}
 public:
 	static const int Rows = TRows;
 	static const int Cols = TCols;
-	DisplayBuffer(char fill = ' ') { clear(fill); }
-	void clear(char fill = ' ') {
+	DisplayBuffer(char fill = ' ') : _inFrame(false), _frameFill(fill) {
 		for (int r = 0; r < TRows; r++) {
 			for (int c = 0; c < TCols; c++) {
 				_data[r][c] = fill;
 			}
 		}
 	}
+	void clear(char fill = ' ') {
+		if (_inFrame) {
+			memset(_drawn, 0, sizeof(_drawn));
+			_frameFill = fill;
+			return;
+		}
+		for (int r = 0; r < TRows; r++) {
+			for (int c = 0; c < TCols; c++) {
+				set(r, c, fill);
+			}
+		}
+	}
+	// Starts a frame that begins as if cleared to fill; see above.
+	void beginFrame(char fill = ' ') {
+		_inFrame = true;
+		clear(fill);
+	}
+	void endFrame() {
+		_inFrame = false;
+		for (int r = 0; r < TRows; r++) {
+			for (int c = 0; c < TCols; c++) {
+				if (!wasDrawn(r, c)) set(r, c, _frameFill);
+			}
+		}
+	}
 	char get(int row, int col) const { return _data[row][col]; }
 	void set(int row, int col, char ch) {
 		if (row < 0 || row >= TRows || col < 0 || col >= TCols) return;
+		if (_inFrame) drawn(row, col);
+		if (_data[row][col] == ch) return;
 		_data[row][col] = ch;
+		_dirty.mark(row, col);
 	}
+	bool dirty() const { return _dirty.dirty(); }
+	bool dirty(int row) const { return _dirty.dirty(row); }
+	// Changed columns of a row are in [dirtyFrom, dirtyTo).
+	int dirtyFrom(int row) const { return _dirty.from(row); }
+	int dirtyTo(int row) const { return _dirty.to(row); }
+	const DirtySpans<TRows, TCols> &dirtySpans() const { return _dirty; }
+	void markClean() { _dirty.clear(); }
 	void write(int row, int col, const char *text, int width = -1) {
 		if (!text) text = "";
 		int len = (int)strlen(text);
@@ -63,6 +153,10 @@ template <class TDisplay, int TRows = 4, int TCols = 20>
 class DisplayDrawable {
 public:
 	virtual void draw(DisplayBuffer<TRows, TCols> &buffer) = 0;
+	// Whether draw() would produce something different from last time.
+	// MainDisplay skips rendering when it's false; drawables that can't
+	// tell keep the default and are redrawn every tick.
+	virtual bool changed() { return true; }
 	virtual bool wantsCursor() { return false; }
 	virtual void cursorPosition(int &col, int &row) { col = 0; row = 0; }
 };
@@ -83,38 +177,239 @@ public:
 			this->item(i)->draw(buffer);
 		}
 	}
+	bool changed() {
+		const int count = this->length();
+		for (int i = 0; i < count; i++) {
+			if (this->item(i)->changed()) return true;
+		}
+		return false;
+	}
+};
+
+/*
+Character LCDs have 8 custom character (CGRAM) slots.  GlyphCache lets
+drawables use more glyphs than that: a drawable writes GlyphSlots::code(id)
+into the buffer, and when MainDisplay flushes it asks the cache for a slot.
+A glyph already in a slot costs nothing; a miss evicts the least recently
+used slot that isn't on screen this frame and uploads the bitmap.  If more
+than 8 different glyphs are on screen at once the extras show as the
+fallback character.
+
+Glyph codes use 0x80-0x9F (GLYPH_CODE_BASE), which are blank in the HD44780
+A00 ROM, so at most GLYPH_CODES distinct glyphs.  Bitmaps are 8 rows of 5
+bits, in RAM or PROGMEM:
+
+const uint8_t sprites[][8] PROGMEM = { { 0x04, 0x0E, ... }, ... };
+GlyphCache<LK204_25_LCD> glyphs(lcd, sprites, 2, true);
+display.glyphs(glyphs);
+... in draw(): buffer.set(row, col, GlyphSlots::code(1));
+*/
+#ifndef GLYPH_CODE_BASE
+#define GLYPH_CODE_BASE 0x80
+#endif
+#define GLYPH_CODES 32
+
+class GlyphSlots {
+public:
+	static const uint8_t Slots = 8;
+	static char code(uint8_t id) { return (char)(GLYPH_CODE_BASE + id); }
+	static bool isGlyph(char ch) { return (uint8_t)ch >= GLYPH_CODE_BASE && (uint8_t)ch < GLYPH_CODE_BASE + GLYPH_CODES; }
+	// Called by MainDisplay for each glyph on screen before a flush.
+	virtual void beginFrame() = 0;
+	virtual void pin(char code) = 0;
+	// The character to send for a glyph code, uploading it on a miss.
+	virtual char resolve(char code) = 0;
+};
+
+template <class TDisplay>
+class GlyphCache : public GlyphSlots {
+	static const uint8_t Empty = 0xFF;
+	TDisplay &_display;
+	const uint8_t (*_bitmaps)[8];
+	uint8_t _count;
+	bool _progmem;
+	char _fallback;
+	uint8_t _slotGlyph[Slots];
+	uint8_t _slotUsed[Slots];
+	uint32_t _framePins;  // bit per glyph id on screen this frame
+	uint8_t _clock;
+	uint16_t _uploads;
+public:
+	GlyphCache(TDisplay &display, const uint8_t (*bitmaps)[8], uint8_t count, bool progmem = false, char fallback = '#') :
+		_display(display), _bitmaps(bitmaps), _count(count < GLYPH_CODES ? count : GLYPH_CODES),
+		_progmem(progmem), _fallback(fallback), _framePins(0), _clock(0), _uploads(0) {
+		invalidate();
+	}
+	// Forget what's in the slots (after the display is reset, say).
+	void invalidate() {
+		for (uint8_t s = 0; s < Slots; s++) {
+			_slotGlyph[s] = Empty;
+			_slotUsed[s] = 0;
+		}
+	}
+	uint16_t uploads() const { return _uploads; }
+	void beginFrame() {
+		_framePins = 0;
+	}
+	void pin(char code) {
+		_framePins |= (uint32_t)1 << ((uint8_t)code - GLYPH_CODE_BASE);
+	}
+	char resolve(char code) {
+		uint8_t id = (uint8_t)code - GLYPH_CODE_BASE;
+		if (id >= _count) {
+			return _fallback;
+		}
+		int8_t s = find(id);
+		if (s < 0) {
+			s = victim();
+			if (s < 0) {
+				return _fallback;
+			}
+			upload(s, id);
+		}
+		_slotUsed[s] = ++_clock;
+		return (char)s;
+	}
+private:
+	int8_t find(uint8_t id) const {
+		for (uint8_t s = 0; s < Slots; s++) {
+			if (_slotGlyph[s] == id) return s;
+		}
+		return -1;
+	}
+	// Empty slots first, then the least recently used one whose glyph isn't
+	// on screen (ages are compared mod 256 against the clock).
+	int8_t victim() const {
+		int8_t best = -1;
+		uint8_t bestAge = 0;
+		for (uint8_t s = 0; s < Slots; s++) {
+			if (_slotGlyph[s] == Empty) return s;
+			if (_framePins & ((uint32_t)1 << _slotGlyph[s])) continue;
+			uint8_t age = _clock - _slotUsed[s];
+			if (best < 0 || age > bestAge) {
+				best = s;
+				bestAge = age;
+			}
+		}
+		return best;
+	}
+	void upload(uint8_t s, uint8_t id) {
+		uint8_t bitmap[8];
+		if (_progmem) {
+			memcpy_P(bitmap, _bitmaps[id], sizeof(bitmap));
+		} else {
+			memcpy(bitmap, _bitmaps[id], sizeof(bitmap));
+		}
+		_display.createChar(s, bitmap);
+		_slotGlyph[s] = id;
+		_uploads++;
+	}
+};
+
+/*
+DisplayCost describes what it takes to update a display: bytes on the bus
+for a cursor move, a character and a clear, plus any time the display needs
+on top of that.  MainDisplay uses it to pick the cheapest way to flush:
+unchanged gaps between changed runs are resent when that's cheaper than a
+cursor move (a whole row is just the case where every gap is), and a clear
+plus the non-blank text is used when most of the screen changed.  Costs
+are compared in microseconds; the defaults are for the LK204-25 at 100kHz.
+*/
+struct DisplayCost {
+	uint8_t cursorBytes;
+	uint8_t charBytes;
+	uint8_t clearBytes;
+	uint16_t cursorMicros;
+	uint16_t charMicros;
+	uint16_t clearMicros;
+	uint16_t byteMicros;
+	DisplayCost(uint8_t cursorBytesValue = 4, uint8_t charBytesValue = 1, uint8_t clearBytesValue = 2,
+			uint16_t cursorMicrosValue = 0, uint16_t charMicrosValue = 0, uint16_t clearMicrosValue = 2000,
+			uint16_t byteMicrosValue = 90) :
+		cursorBytes(cursorBytesValue), charBytes(charBytesValue), clearBytes(clearBytesValue),
+		cursorMicros(cursorMicrosValue), charMicros(charMicrosValue), clearMicros(clearMicrosValue),
+		byteMicros(byteMicrosValue) { }
+	long cursor() const { return (long)cursorBytes * byteMicros + cursorMicros; }
+	long chars(int n) const { return n * ((long)charBytes * byteMicros + charMicros); }
+	long clear() const { return (long)clearBytes * byteMicros + clearMicros; }
+};
+
+const DisplayCost DisplayCost_LK204;
+// HD44780 on a PCF8574 backpack (LiquidCrystal_I2C): every byte is sent a
+// nibble at a time with enable pulses, roughly 12 bus bytes each.
+const DisplayCost DisplayCost_HD44780_I2C(12, 12, 12, 40, 40, 1600, 90);
+
+// Where the cursor should be, as of the last render.
+struct DisplayCursor {
+	bool shown;
+	int col;
+	int row;
+	DisplayCursor() : shown(false), col(0), row(0) { }
+};
+
+// One device MainDisplay renders to.  MainDisplay hands every rendered frame
+// to frameChanged() and calls poll() each time it runs; when and how the
+// device is updated is up to the output.
+template <int TRows = 4, int TCols = 20>
+class DisplayOutputBase {
+public:
+	virtual void begin() = 0;
+	virtual void frameChanged(const DisplayBuffer<TRows, TCols> &frame) = 0;
+	virtual void poll(const DisplayBuffer<TRows, TCols> &frame, const DisplayCursor &cursor) = 0;
 };
 
+/*
+Sends frames to an ILCD-style display at its own refresh rate.  It keeps
+its own copy of what's on the display and its own record of what changed
+since it last flushed, so outputs of different speeds on one MainDisplay
+never wait for each other: a slow one just sends the sum of several frames'
+changes at once.
+*/
 template <class TDisplay, int TRows = 4, int TCols = 20>
-class MainDisplay : private Scheduled {
-    TDisplay &_display;
-    DisplayDrawable<TDisplay, TRows, TCols> &_drawable;
- 	Timer _tick;
- 	Timer _full;
- 	DisplayBuffer<TRows, TCols> _desired;
- 	DisplayBuffer<TRows, TCols> _flushed;
- 	bool _hasFlushed;
+class DisplayOutput : public DisplayOutputBase<TRows, TCols> {
+	TDisplay &_display;
+	Timer _tick;
+	Timer _full;
+	DisplayBuffer<TRows, TCols> _flushed;
+	DirtySpans<TRows, TCols> _dirty;  // changed since the last flush
+	const DisplayBuffer<TRows, TCols> *_frame;
+	bool _pending;
+	bool _hasFlushed;
+	const DisplayCost _cost;
+	bool _cursorShown;
+	int _cursorCol;
+	int _cursorRow;
+	unsigned long _bytesSent;
+	long _bytesSaved;
+	bool _scanAll;
+	GlyphSlots *_glyphs;
 public:
-    MainDisplay(Schedule &schedule, TDisplay &display, DisplayDrawable<TDisplay, TRows, TCols> &drawable, long period, long fullRefreshPeriod = 5000L) : 
-        Scheduled(schedule),
- 		_display(display),
- 		_drawable(drawable),
- 		_tick(period),
- 		_full(fullRefreshPeriod),
- 		_desired(' '),
- 		_flushed(' '),
- 		_hasFlushed(false) { }
-    void begin() {
- 		_tick.reset();
- 		_full.reset();
-        _display.begin();
-        _display.backlight();
-        _display.clear();
-        _display.home();
-        _display.noCursor();
+	DisplayOutput(TDisplay &display, long period, long fullRefreshPeriod = 5000L, const DisplayCost &cost = DisplayCost()) :
+		_display(display),
+		_tick(period),
+		_full(fullRefreshPeriod),
+		_flushed(' '),
+		_frame(0),
+		_pending(false),
+		_hasFlushed(false),
+		_cost(cost),
+		_cursorShown(false), _cursorCol(-1), _cursorRow(-1),
+		_bytesSent(0), _bytesSaved(0), _scanAll(false), _glyphs(0) { }
+	void begin() {
+		_tick.reset();
+		_full.reset();
+		_display.begin();
+		_display.backlight();
+		_display.clear();
+		_display.home();
+		_display.noCursor();
 		_hasFlushed = false;
-    }
-    void poll() override {
+	}
+	void frameChanged(const DisplayBuffer<TRows, TCols> &frame) {
+		_dirty.merge(frame.dirtySpans());
+		_pending = true;
+	}
+	void poll(const DisplayBuffer<TRows, TCols> &frame, const DisplayCursor &cursor) {
 		if (_tick.expired()) {
 			_tick.reset();
 			bool forceFull = false;
@@ -122,56 +417,230 @@ public:
 				_full.reset();
 				forceFull = true;
 			}
-			render();
-			flush(forceFull);
+			if (_pending || forceFull || !_hasFlushed) {
+				_frame = &frame;
+				flush(cursor, forceFull);
+			}
 		}
-    }
- private:
- 	void render() {
- 		_desired.clear(' ');
- 		_drawable.draw(_desired);
- 	}
- 	void flush(bool forceFull) {
-		if (forceFull || !_hasFlushed) {
+	}
+	// Custom glyphs in the buffer are mapped to CGRAM slots through this.
+	void glyphs(GlyphSlots &glyphs) { _glyphs = &glyphs; }
+	// Bus bytes sent, and saved against sending each changed run on its own.
+	unsigned long bytesSent() const { return _bytesSent; }
+	long bytesSaved() const { return _bytesSaved; }
+private:
+	void flush(const DisplayCursor &cursor, bool forceFull) {
+		bool all = forceFull || !_hasFlushed;
+		long naive = 0;
+		unsigned long sent = _bytesSent;
+		bool wrote = false;
+		_scanAll = all;
+		_pending = false;
+		if (all) {
 			_flushed.clear((char)0);
+		} else if (!_dirty.dirty()) {
+			flushCursor(cursor, false, false);
+			_display.flush();
+			return;
+		} else {
+			// Compare the diff against clearing and redrawing what isn't blank.
+			long diffCost = 0;
+			long clearCost = _cost.clear();
+			for (int row = 0; row < TRows; row++) {
+				diffCost += flushRow(row, false, false, naive);
+				clearCost += flushRow(row, true, false, naive);
+			}
+			if (clearCost < diffCost) {
+				_display.clear();
+				_bytesSent += _cost.clearBytes;
+				_flushed.clear(' ');
+				_scanAll = true;
+				_cursorCol = -1;
+				wrote = true;
+			}
 		}
-		for (int row = 0; row < DisplayBuffer<TRows, TCols>::Rows; row++) {
-			int col = 0;
-			while (col < DisplayBuffer<TRows, TCols>::Cols) {
-				char desiredCh = _desired.get(row, col);
-				char flushedCh = _flushed.get(row, col);
-				bool changed = forceFull || !_hasFlushed || desiredCh != flushedCh;
-				if (!changed) {
-					col++;
-					continue;
-				}
-				int start = col;
-				char run[DisplayBuffer<TRows, TCols>::Cols + 1];
-				int runLen = 0;
-				while (col < DisplayBuffer<TRows, TCols>::Cols) {
-					desiredCh = _desired.get(row, col);
-					flushedCh = _flushed.get(row, col);
-					changed = forceFull || !_hasFlushed || desiredCh != flushedCh;
-					if (!changed) break;
-					run[runLen++] = desiredCh;
-					_flushed.set(row, col, desiredCh);
-					col++;
+		pinGlyphs();
+		for (int row = 0; row < TRows; row++) {
+			if (flushRow(row, false, true, naive) > 0) {
+				wrote = true;
+			}
+		}
+		if (!all) {
+			_bytesSaved += naive - (long)(_bytesSent - sent);
+		}
+		flushCursor(cursor, all, wrote);
+		_display.flush();
+		_dirty.clear();
+		_hasFlushed = true;
+	}
+	// Walks the changed cells of a row, merging runs whose gap is cheaper to
+	// resend than a cursor move.  Returns the cost, or sends it if emit is set.
+	// naive adds up the bytes for sending every changed run separately.
+	// Only the dirty span of the row is scanned unless everything is being
+	// redrawn (after a clear, or a full refresh).
+	long flushRow(int row, bool againstBlank, bool emit, long &naive) {
+		long cost = 0;
+		int start = -1;
+		int end = -1;
+		bool whole = againstBlank || _scanAll;
+		int col = whole ? 0 : _dirty.from(row);
+		int last = whole ? TCols : _dirty.to(row);
+		while (col < last) {
+			if (!changed(row, col, againstBlank)) {
+				col++;
+				continue;
+			}
+			int runStart = col;
+			while (col < last && changed(row, col, againstBlank)) {
+				col++;
+			}
+			if (!againstBlank && !emit) {
+				naive += _cost.cursorBytes + (long)(col - runStart) * _cost.charBytes;
+			}
+			if (start >= 0 && _cost.chars(runStart - end) <= _cost.cursor()) {
+				end = col;
+				continue;
+			}
+			if (start >= 0) {
+				cost += span(row, start, end, emit);
+			}
+			start = runStart;
+			end = col;
+		}
+		if (start >= 0) {
+			cost += span(row, start, end, emit);
+		}
+		return cost;
+	}
+	// Glyphs on screen after this flush mustn't be evicted to make room for others.
+	void pinGlyphs() {
+		if (!_glyphs) return;
+		_glyphs->beginFrame();
+		for (int row = 0; row < TRows; row++) {
+			for (int col = 0; col < TCols; col++) {
+				char ch = _frame->get(row, col);
+				if (GlyphSlots::isGlyph(ch)) _glyphs->pin(ch);
+			}
+		}
+	}
+	bool changed(int row, int col, bool againstBlank) const {
+		char desiredCh = _frame->get(row, col);
+		return desiredCh != (againstBlank ? ' ' : _flushed.get(row, col));
+	}
+	long span(int row, int start, int end, bool emit) {
+		if (emit) {
+			char run[TCols];
+			int runLen = 0;
+			for (int col = start; col < end; col++) {
+				char ch = _frame->get(row, col);
+				_flushed.set(row, col, ch);
+				if (_glyphs && GlyphSlots::isGlyph(ch)) {
+					ch = _glyphs->resolve(ch);
 				}
-				run[runLen] = 0;
-				_display.setCursor(start, row);
-				_display.print(run);
+				run[runLen++] = ch;
 			}
+			// Glyph slot 0 is a NUL, so this can't go through print().
+			_display.setCursor(start, row);
+			_display.write((const uint8_t *)run, runLen);
+			_bytesSent += _cost.cursorBytes + (unsigned long)runLen * _cost.charBytes;
 		}
-		if (_drawable.wantsCursor()) {
-			int cursorCol = 0;
-			int cursorRow = 0;
-			_drawable.cursorPosition(cursorCol, cursorRow);
-			_display.cursor();
-			_display.setCursor((uint8_t)cursorCol, (uint8_t)cursorRow);
-		} else {
+		return _cost.cursor() + _cost.chars(end - start);
+	}
+	// Cursor commands are only sent when something changed.  Writing text
+	// moves the hardware cursor, so a visible one is put back afterwards.
+	void flushCursor(const DisplayCursor &cursor, bool all, bool wrote) {
+		if (cursor.shown) {
+			if (all || !_cursorShown) {
+				_display.cursor();
+				_cursorShown = true;
+			}
+			if (all || wrote || cursor.col != _cursorCol || cursor.row != _cursorRow) {
+				_display.setCursor((uint8_t)cursor.col, (uint8_t)cursor.row);
+				_bytesSent += _cost.cursorBytes;
+				_cursorCol = cursor.col;
+				_cursorRow = cursor.row;
+			}
+		} else if (all || _cursorShown) {
 			_display.noCursor();
+			_cursorShown = false;
 		}
-		_hasFlushed = true;
+	}
+};
+
+/*
+Renders a drawable into one DisplayBuffer every period and fans it out to
+its outputs.  The display passed in is the first output, refreshed at the
+same period; add() more, each with its own rate.  Rendering happens once
+per tick however many outputs there are.
+
+LK204_25_LCD lcd;
+LiquidCrystal_I2C lcd2(0x27, 20, 4);
+MainDisplay<LK204_25_LCD, 4, 20> display(schedule, lcd, renderer, 100);
+DisplayOutput<LiquidCrystal_I2C, 4, 20> mirror(lcd2, 250, 5000L, DisplayCost_HD44780_I2C);
+void setup() { display.add(mirror); display.begin(); ... }
+*/
+template <class TDisplay, int TRows = 4, int TCols = 20>
+class MainDisplay : private Scheduled {
+	DisplayDrawable<TDisplay, TRows, TCols> &_drawable;
+	Timer _tick;
+	DisplayBuffer<TRows, TCols> _desired;
+	DisplayCursor _cursor;
+	bool _rendered;
+	DisplayOutput<TDisplay, TRows, TCols> _primary;
+	List<DisplayOutputBase<TRows, TCols>*> _outputs;
+public:
+	MainDisplay(Schedule &schedule, TDisplay &display, DisplayDrawable<TDisplay, TRows, TCols> &drawable, long period, long fullRefreshPeriod = 5000L, const DisplayCost &cost = DisplayCost()) :
+		Scheduled(schedule),
+		_drawable(drawable),
+		_tick(period),
+		_desired(' '),
+		_rendered(false),
+		_primary(display, period, fullRefreshPeriod, cost) {
+		_outputs.add(&_primary);
+	}
+	// Outputs added after begin() need their own begin().
+	void add(DisplayOutputBase<TRows, TCols> &output) { _outputs.add(&output); }
+	void begin() {
+		_tick.reset();
+		for (int i = 0; i < _outputs.length(); i++) {
+			_outputs[i]->begin();
+		}
+		_rendered = false;
+	}
+	void poll() override {
+		if (_tick.expired()) {
+			_tick.reset();
+			if (render()) {
+				for (int i = 0; i < _outputs.length(); i++) {
+					_outputs[i]->frameChanged(_desired);
+				}
+				_desired.markClean();
+			}
+			_cursor.shown = _drawable.wantsCursor();
+			if (_cursor.shown) {
+				_drawable.cursorPosition(_cursor.col, _cursor.row);
+			}
+		}
+		if (!_rendered) return;
+		for (int i = 0; i < _outputs.length(); i++) {
+			_outputs[i]->poll(_desired, _cursor);
+		}
+	}
+	// These apply to the display passed to the constructor.
+	void glyphs(GlyphSlots &glyphs) { _primary.glyphs(glyphs); }
+	unsigned long bytesSent() const { return _primary.bytesSent(); }
+	long bytesSaved() const { return _primary.bytesSaved(); }
+private:
+	bool render() {
+		if (_rendered && !_drawable.changed()) {
+			return false;
+		}
+		// Only cells that differ from the last frame end up dirty.
+		_desired.beginFrame(' ');
+		_drawable.draw(_desired);
+		_desired.endFrame();
+		_rendered = true;
+		return true;
 	}
 };
 
@@ -180,11 +649,15 @@ class DisplayLabel : public DisplayDrawable<TDisplay, TRows, TCols> {
     int _row;
     int _col;
     const char *_text;
+    bool _drawn;
 public:
-    DisplayLabel(int row, int col, const char *text) : _row(row), _col(col), _text(text) { }
+    // The text is expected to stay the same once drawn.
+    DisplayLabel(int row, int col, const char *text) : _row(row), _col(col), _text(text), _drawn(false) { }
     void draw(DisplayBuffer<TRows, TCols> &buffer) {
 		buffer.write(_row, _col, _text);
+		_drawn = true;
     }
+    bool changed() { return !_drawn; }
 };
 
 template <class TDisplay, int TRows = 4, int TCols = 20>
@@ -194,10 +667,12 @@ class Spinner : public DisplayDrawable<TDisplay, TRows, TCols> {
   int _col;
   const char *_chars;
   int _idx;
+  bool _spinning;
 public:
-  Spinner(int row, int col, Enabled &enabled, const char *chars = "* "): _row(row), _col(col), _enabled(enabled), _idx(0), _chars(chars) {}
+  Spinner(int row, int col, Enabled &enabled, const char *chars = "* "): _row(row), _col(col), _enabled(enabled), _idx(0), _chars(chars), _spinning(true) {}
   void draw(DisplayBuffer<TRows, TCols> &buffer) {
-    if (_enabled.enabled()) {
+    _spinning = _enabled.enabled();
+    if (_spinning) {
       int len = (int)strlen(_chars);
       if (len > 0) {
         buffer.set(_row, _col, _chars[_idx]);
@@ -207,6 +682,7 @@ public:
       buffer.set(_row, _col, ' ');
     }
   }
+  bool changed() { return _spinning || _enabled.enabled(); }
 };
 
 template <class TDisplay, class TValue, int TRows = 4, int TCols = 20>
@@ -217,12 +693,17 @@ class DisplayValue : public DisplayDrawable<TDisplay, TRows, TCols> {
   TValue &_value;
   const char *_after;
   int _width;
+  TValue _drawnValue;
+  bool _drawn;
 public:
   DisplayValue(int row, int col, const char *before, TValue &value, const char *after):
-    _row(row), _col(col), _before(before), _value(value), _after(after), _width(0) {}
+    _row(row), _col(col), _before(before), _value(value), _after(after), _width(0), _drawn(false) {}
   DisplayValue(int row, int col, const char *before, TValue &value, const char *after, int width):
-    _row(row), _col(col), _before(before), _value(value), _after(after), _width(width) {}
+    _row(row), _col(col), _before(before), _value(value), _after(after), _width(width), _drawn(false) {}
+  bool changed() { return !_drawn || _value != _drawnValue; }
   void draw(DisplayBuffer<TRows, TCols> &buffer) {
+		_drawnValue = _value;
+		_drawn = true;
 		char temp[32];
 		temp[0] = 0;
 		int offset = 0;
@@ -230,9 +711,9 @@ public:
 			buffer.write(_row, _col + offset, _before);
 			offset += (int)strlen(_before);
 		}
-		snprintf(temp, sizeof(temp), "%ld", (long)_value);
+		int length = Format::decimal(temp, sizeof(temp), (long)_value);
 		int valueWidth = _width;
-		if (valueWidth <= 0) valueWidth = (int)strlen(temp);
+		if (valueWidth <= 0) valueWidth = length;
 		buffer.write(_row, _col + offset, temp, valueWidth);
 		offset += valueWidth;
 		if (_after) {
@@ -275,7 +756,7 @@ protected:
 };
 #endif
 
-/* Not sure what to do with space invaders... yet.
+/* Space invaders, two frames of a two-cell invader, for GlyphCache.
 https://www.ibbotson.co.uk/software/invaders/2020/12/22/space-invaders-charactermaps.html
 uint8_t space_1_a_left[8] = {
   0b00011,
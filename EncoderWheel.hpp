@@ -29,6 +29,7 @@ SOFTWARE.
 #include <EdgeDetector.hpp>
 #include <Mapper.hpp>
 #include <SerialPlot.hpp>
+#include <DeferredLog.hpp>
 
 /*
 EncoderWheel and EncoderControl allow the encoder wheel to be an input to
@@ -57,11 +58,183 @@ struct EncoderConfig {
 	EncoderConfig(int clkPinValue, int dtPinValue) : clockPin(clkPinValue), dataPin(dtPinValue) { }
 };
 
-class EncoderWheelHandler : public EdgeDetectorBase {
+// Quarter-steps per reported count.  Detented wheels go through all four
+// quadrature states per click, so Encoder_1x gives one count per detent.
+enum EncoderResolution {
+	Encoder_1x = 4,
+	Encoder_2x = 2,
+	Encoder_4x = 1
+};
+
+/*
+QuadratureDecoder is a table-driven state machine over both channels.
+State is (clock << 1) | data.  Every valid transition is a quarter step; a
+jump where both channels changed at once can't be decoded (missed edge or
+noise) and is reported as Invalid rather than guessed at.  The quarters
+already counted toward the next count are kept, so one missed state costs
+that state and not the whole detent.  Contact bounce shows up as +1/-1
+pairs that cancel, so it's rejected for free.
+
+Polled, this needs every state seen: the loop has to come round at least
+four times per detent at the fastest turn (under 2ms per loop for 120
+detents a second).  A slower loop loses counts and errors() climbs; use
+InterruptEncoderControl, or the PCNT backend on ESP32, if it can't keep up.
+*/
+class QuadratureDecoder {
+	uint8_t _state;
+	int8_t _quarters;
+	int8_t _perCount;
+	int8_t accumulate(int8_t quarters) {
+		_quarters += quarters;
+		if (_quarters >= _perCount) {
+			_quarters -= _perCount;
+			return +1;
+		}
+		if (_quarters <= -_perCount) {
+			_quarters += _perCount;
+			return -1;
+		}
+		return 0;
+	}
+public:
+	static const int8_t Invalid = 2;
+
+	QuadratureDecoder(EncoderResolution resolution = Encoder_1x) :
+		_state(3), _quarters(0), _perCount(resolution) { }
+	void begin(uint8_t state) {
+		_state = state & 3;
+		_quarters = 0;
+	}
+	void resolution(EncoderResolution resolution) {
+		_perCount = resolution;
+		_quarters = 0;
+	}
+	// Returns +1/-1 when a full count is reached, 0 otherwise, or Invalid.
+	int8_t update(uint8_t state) {
+		static const int8_t quarters[16] = {
+			 0, -1, +1, Invalid,
+			+1,  0, Invalid, -1,
+			-1, Invalid,  0, +1,
+			Invalid, +1, -1,  0
+		};
+		state &= 3;
+		int8_t q = quarters[(_state << 2) | state];
+		_state = state;
+		if (q == Invalid) {
+			return Invalid;
+		}
+		return accumulate(q);
+	}
+	// For when only the clock pin can interrupt: each clock edge is half a
+	// cycle, with direction taken from the data level at that edge.
+	int8_t updateClock(bool clock, bool data) {
+		_state = (clock << 1) | data;
+		return accumulate(clock != data ? +2 : -2);
+	}
+};
+
+// Counts per second over a short window, for both encoder wheel flavours.
+class EncoderVelocity {
+	long _lastPosition;
+	unsigned long _lastMs;
+	long _velocity;
+public:
+	static const long WindowMs = 100;
+	EncoderVelocity() : _lastPosition(0), _lastMs(0), _velocity(0) { }
+	void update(long position) {
+		unsigned long now = millis();
+		long elapsed = (long)(now - _lastMs);
+		if (elapsed >= WindowMs) {
+			_velocity = (position - _lastPosition) * 1000L / elapsed;
+			_lastPosition = position;
+			_lastMs = now;
+		}
+	}
+	long velocity() const { return _velocity; }
+};
+
+/*
+Acceleration curves map the time between counts to a step multiplier, so a
+slow turn still moves one step per click and a fast spin covers the range in
+a few turns.  Rows are checked in order and the first one whose intervalUs is
+longer than the gap since the last count wins; a row of { 0, 0 } ends the
+curve, and anything slower steps by 1.  Define your own the same way:
+
+const EncoderAccelStep myCurve[] = { { 5000, 20 }, { 20000, 4 }, { 0, 0 } };
+encoder.acceleration(myCurve);
+*/
+struct EncoderAccelStep {
+	unsigned long intervalUs;
+	uint8_t multiplier;
+};
+
+const EncoderAccelStep EncoderAccel_Gentle[] = { { 15000, 4 }, { 40000, 2 }, { 0, 0 } };
+const EncoderAccelStep EncoderAccel_Fast[] = { { 8000, 16 }, { 20000, 6 }, { 50000, 2 }, { 0, 0 } };
+
+// Integer-only so it can run inside the encoder ISR.  A change of direction
+// always steps by 1, so rocking the wheel back to correct an overshoot
+// doesn't jump.
+class EncoderAcceleration {
+	const EncoderAccelStep *_curve;
+	unsigned long _lastUs;
+	int8_t _lastDirection;
+public:
+	EncoderAcceleration() : _curve(0), _lastUs(0), _lastDirection(0) { }
+	void curve(const EncoderAccelStep *curve) { _curve = curve; }
+	// Call once per count with its direction (+1/-1); returns the steps it's worth.
+	// When several counts in the same direction are read back at once, pass
+	// how many: the time since the last call is shared between them, and the
+	// result is what each of them is worth.
+	uint8_t step(int8_t direction, unsigned long nowUs, unsigned long counts = 1) {
+		unsigned long interval = (nowUs - _lastUs) / (counts ? counts : 1);
+		bool reversed = direction != _lastDirection;
+		_lastUs = nowUs;
+		_lastDirection = direction;
+		if (!_curve || reversed) {
+			return 1;
+		}
+		for (const EncoderAccelStep *row = _curve; row->intervalUs; row++) {
+			if (interval < row->intervalUs) {
+				return row->multiplier;
+			}
+		}
+		return 1;
+	}
+};
+
+/*
+On ESP32, EncoderWheelHandler counts in a PCNT unit instead of polling the
+pins.  Both channels are wired for full quadrature, so the hardware sees every
+edge at zero CPU cost per tick and nothing is lost while Wi-Fi or a web server
+holds up the loop.  Short glitches are filtered in hardware and the 16-bit
+counter is extended in software on overflow, so poll() only reads back the
+count.  Contact bounce cancels out in the count, and missed edges can't
+happen, so errors() stays 0.  If no PCNT unit is free (4 on ESP32-S3, 8 on
+ESP32) the wheel falls back to polling.  Define ENCODER_NO_PCNT before
+including this file to always poll.
+*/
+#if defined(ARDUINO_ARCH_ESP32) && !defined(ENCODER_NO_PCNT)
+#define ENCODER_PCNT
+#include <driver/pulse_cnt.h>
+#endif
+
+class EncoderWheelHandler : private Scheduled {
 	DigitalRead _clk;
 	DigitalRead _data;
 	bool _clkValue;
 	bool _dtValue;
+	QuadratureDecoder _decoder;
+	long _position;
+	uint16_t _errors;
+	EncoderVelocity _velocity;
+	EncoderAcceleration _acceleration;
+	uint8_t _multiplier;
+#ifdef ENCODER_PCNT
+	pcnt_unit_handle_t _unit;
+	int _lastCount;
+	int _quarters;
+	int8_t _perCount;
+#endif
 public:
 	static const uint8_t ENCODER_NONE = 0;
 	static const uint8_t ENCODER_WHEEL_LEFT = 1;
@@ -72,21 +245,122 @@ public:
 	EncoderWheelHandler(Schedule &schedule, const EncoderConfig &config) :
 		EncoderWheelHandler(schedule, config.clockPin, config.dataPin) { }
 	EncoderWheelHandler(Schedule &schedule, int clockPin, int dataPin) : 
-		EdgeDetectorBase(schedule, _clkValue),
+		Scheduled(schedule),
 		_clk(schedule, clockPin, _clkValue, INPUT_PULLUP), 
-		_data(schedule, dataPin, _dtValue, INPUT_PULLUP) { }
-	void onRisingEdge() {
-		if (_dtValue != _clkValue) {
-			handleInput(ENCODER_WHEEL_RIGHT);
-		} else {
-			handleInput(ENCODER_WHEEL_LEFT);
+		_data(schedule, dataPin, _dtValue, INPUT_PULLUP),
+		_position(0), _errors(0), _multiplier(1) {
+		// The DigitalReads may not poll before we do, so take the starting
+		// state from the pins now rather than from values never read.
+		_clkValue = digitalRead(clockPin);
+		_dtValue = digitalRead(dataPin);
+		_decoder.begin((_clkValue << 1) | _dtValue);
+#ifdef ENCODER_PCNT
+		_unit = beginPcnt(clockPin, dataPin);
+		_lastCount = 0;
+		_quarters = 0;
+		_perCount = Encoder_1x;
+		if (!_unit) {
+			LOG_DEFER2("Encoder %d/%d: no PCNT unit free, polling", clockPin, dataPin);
+		}
+#endif
+	}
+	void poll() {
+#ifdef ENCODER_PCNT
+		if (_unit) {
+			pollPcnt();
+			_velocity.update(_position);
+			return;
 		}
+#endif
+		uint8_t state = (_clkValue << 1) | _dtValue;
+		int8_t step = _decoder.update(state);
+		if (step == QuadratureDecoder::Invalid) {
+			_errors++;
+		} else if (step) {
+			count(step, _acceleration.step(step, micros()));
+		}
+		_velocity.update(_position);
+	}
+	void resolution(EncoderResolution resolution) {
+		_decoder.resolution(resolution);
+#ifdef ENCODER_PCNT
+		_perCount = resolution;
+		_quarters = 0;
+#endif
 	}
-	void onFallingEdge() { }
+	void acceleration(const EncoderAccelStep *curve) { _acceleration.curve(curve); }
+	// Steps the count being handled is worth; 1 unless a curve is set.
+	uint8_t multiplier() const { return _multiplier; }
+	long position() const { return _position; }
+	long velocity() const { return _velocity.velocity(); }
+	uint16_t errors() const { return _errors; }
 	void plot(PlotComposite &plot, String name) {
 		PlotBool::addToPlot(plot, name + ".clock", _clkValue);
 		PlotBool::addToPlot(plot, name + ".data", _dtValue);
 	}
+private:
+	void count(int8_t step, uint8_t multiplier) {
+		_position += step;
+		_multiplier = multiplier;
+		handleInput(step > 0 ? ENCODER_WHEEL_RIGHT : ENCODER_WHEEL_LEFT);
+	}
+#ifdef ENCODER_PCNT
+	// Every edge of either channel is a quarter step; the level of the other
+	// channel gives the direction (same sense as QuadratureDecoder).
+	static pcnt_unit_handle_t beginPcnt(int clockPin, int dataPin) {
+		pcnt_unit_config_t unitConfig = {};
+		unitConfig.low_limit = -32768;
+		unitConfig.high_limit = 32767;
+		unitConfig.flags.accum_count = 1;
+		pcnt_unit_handle_t unit = NULL;
+		if (pcnt_new_unit(&unitConfig, &unit) != ESP_OK) {
+			return NULL;
+		}
+		pcnt_glitch_filter_config_t filter = {};
+		filter.max_glitch_ns = 1000;
+		pcnt_unit_set_glitch_filter(unit, &filter);
+		pcnt_chan_config_t clockConfig = {};
+		clockConfig.edge_gpio_num = clockPin;
+		clockConfig.level_gpio_num = dataPin;
+		pcnt_channel_handle_t clockChannel = NULL;
+		pcnt_new_channel(unit, &clockConfig, &clockChannel);
+		pcnt_channel_set_edge_action(clockChannel, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+		pcnt_channel_set_level_action(clockChannel, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+		pcnt_chan_config_t dataConfig = {};
+		dataConfig.edge_gpio_num = dataPin;
+		dataConfig.level_gpio_num = clockPin;
+		pcnt_channel_handle_t dataChannel = NULL;
+		pcnt_new_channel(unit, &dataConfig, &dataChannel);
+		pcnt_channel_set_edge_action(dataChannel, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+		pcnt_channel_set_level_action(dataChannel, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+		// accum_count only carries past the limits if there are watch points on them.
+		pcnt_unit_add_watch_point(unit, unitConfig.low_limit);
+		pcnt_unit_add_watch_point(unit, unitConfig.high_limit);
+		pcnt_unit_enable(unit);
+		pcnt_unit_clear_count(unit);
+		pcnt_unit_start(unit);
+		return unit;
+	}
+	void pollPcnt() {
+		int now = 0;
+		pcnt_unit_get_count(_unit, &now);
+		_quarters += (int)((unsigned)now - (unsigned)_lastCount);
+		_lastCount = now;
+		int counts = _quarters / _perCount;
+		if (!counts) {
+			return;
+		}
+		_quarters -= counts * _perCount;
+		// After a stall the counts all arrive in one poll; pace them over
+		// the time since the last one instead of as if they were 0us apart.
+		int8_t step = counts > 0 ? +1 : -1;
+		unsigned long n = counts > 0 ? counts : -counts;
+		uint8_t multiplier = _acceleration.step(step, micros(), n);
+		for (unsigned long i = 0; i < n; i++) {
+			count(step, multiplier);
+		}
+	}
+#endif
 };
 
 class EncoderWheel : public EncoderWheelHandler {
@@ -99,9 +373,9 @@ public:
 		EncoderWheelHandler(schedule, clockPin, dataPin), _value(value), _limit(limit) { }
 	void handleInput(uint8_t input) {
 		if (input == ENCODER_WHEEL_LEFT) {
-			_value = constrain(_value - 1, 0, _limit);
+			_value = constrain(_value - multiplier(), 0, _limit);
 		} else if (input == ENCODER_WHEEL_RIGHT) {
-			_value = constrain(_value + 1, 0, _limit);
+			_value = constrain(_value + multiplier(), 0, _limit);
 		}
 	}
 	void plot(PlotComposite &plot, String name) {
@@ -124,6 +398,11 @@ public:
 		EncoderControl(schedule, config, value, sensitivity, maxVal) { }
 	EncoderControl(Schedule &schedule, int clockPin, int dataPin, T &value, int sensitivity, T maxVal, int /*slot*/) :
 		EncoderControl(schedule, clockPin, dataPin, value, sensitivity, maxVal) { }
+	using EncoderWheelHandler::resolution;
+	using EncoderWheelHandler::acceleration;
+	using EncoderWheelHandler::position;
+	using EncoderWheelHandler::velocity;
+	using EncoderWheelHandler::errors;
 	void plot(PlotComposite &plot, String name) {
 		EncoderWheel::plot(plot, name);
 	}
@@ -141,7 +420,7 @@ public:
         "R4 Minima (RA4M1): all pins. " \
         "Use EncoderControl<T> for polling fallback, or rewire to an INT pin.")
 
-// Two-slot interrupt-driven encoder support.
+// Interrupt-driven encoder support.
 // On R4 Minima (RA4M1) all digital pins support attachInterrupt — no rewiring needed.
 // On ATmega32u4 (Pro Micro) only pins 0, 1, 2, 3, 7 are INT-capable.
 //
@@ -149,76 +428,167 @@ public:
 //   long speed = 0;
 //   InterruptEncoderControl<long> enc(schedule, Config.Left.Encoder, speed, 20, 100, /*slot=*/0);
 //
-// The slot parameter (0 or 1) selects which ISR pair to use; each physical
-// encoder must use a different slot.
+// The slot parameter selects which ISR to use; each physical encoder must use a
+// different slot.  There are ENCODER_ISR_SLOTS of them (default 2); define it
+// before including this file to get more.
+//
+// Both pins interrupt on CHANGE when they can, so every quadrature state is
+// seen.  If only the clock pin is INT-capable the slot falls back to clock
+// edges only (2x at most).
+
+#ifndef ENCODER_ISR_SLOTS
+#define ENCODER_ISR_SLOTS 2
+#endif
 
 namespace _EncoderISR {
-    volatile int _delta[2];
-    int _dataPin[2];
+    struct Slot {
+        volatile long position;
+        volatile long travel;      // position with acceleration applied
+        volatile uint16_t errors;
+        QuadratureDecoder decoder;
+        EncoderAcceleration acceleration;
+        bool clockOnly;
+        int clockPin;
+        int dataPin;
+#if defined(__AVR__)
+        volatile uint8_t *clockPort;
+        volatile uint8_t *dataPort;
+        uint8_t clockMask;
+        uint8_t dataMask;
+#endif
+    };
+    Slot _slot[ENCODER_ISR_SLOTS];
+
+    // Both channels are sampled together; on AVR that's a single port read
+    // when the pins share a port.
+    inline uint8_t read(const Slot &slot) {
+#if defined(__AVR__)
+        uint8_t clockPort = *slot.clockPort;
+        uint8_t dataPort = slot.dataPort == slot.clockPort ? clockPort : *slot.dataPort;
+        return ((clockPort & slot.clockMask) ? 2 : 0) | ((dataPort & slot.dataMask) ? 1 : 0);
+#else
+        bool clock = digitalRead(slot.clockPin);
+        bool data = digitalRead(slot.dataPin);
+        return (clock << 1) | data;
+#endif
+    }
     inline void tick(int s) {
-        _delta[s] += digitalRead(_dataPin[s]) ? +1 : -1;
-        Serial.print("ISR slot ");
-        Serial.print(s);
-        Serial.print(" tick, delta now ");
-        Serial.println(_delta[s]);
+        Slot &slot = _slot[s];
+        uint8_t state = read(slot);
+        int8_t step = slot.clockOnly ?
+            slot.decoder.updateClock(state & 2, state & 1) :
+            slot.decoder.update(state);
+        if (step == QuadratureDecoder::Invalid) {
+            slot.errors++;
+        } else if (step) {
+            slot.position += step;
+            slot.travel += step * slot.acceleration.step(step, micros());
+            LOG_DEFER2("ISR slot %d tick, position now %ld", s, slot.position);
+        }
+    }
+
+    template <int S>
+    void isr() { tick(S); }
+
+    typedef void (*Isr)();
+    template <int N>
+    struct IsrTable {
+        static Isr get(int s) { return s == N - 1 ? &isr<N - 1> : IsrTable<N - 1>::get(s); }
+    };
+    template <>
+    struct IsrTable<0> {
+        static Isr get(int) { return 0; }
+    };
+
+    inline long position(int s) {
+        noInterrupts();
+        long result = _slot[s].position;
+        interrupts();
+        return result;
+    }
+    inline long travel(int s) {
+        noInterrupts();
+        long result = _slot[s].travel;
+        interrupts();
+        return result;
+    }
+    inline uint16_t errors(int s) {
+        noInterrupts();
+        uint16_t result = _slot[s].errors;
+        interrupts();
+        return result;
+    }
+    inline void resolution(int s, EncoderResolution resolution) {
+        noInterrupts();
+        _slot[s].decoder.resolution(resolution);
+        interrupts();
+    }
+    inline void acceleration(int s, const EncoderAccelStep *curve) {
+        noInterrupts();
+        _slot[s].acceleration.curve(curve);
+        interrupts();
     }
-    void isr0() { tick(0); }
-    void isr1() { tick(1); }
 }
 
 class InterruptEncoderWheel : private Scheduled {
-    volatile int &_delta;
+    int _slot;
     int &_value;
     int _limit;
+    long _lastTravel;
+    EncoderVelocity _velocity;
 public:
     InterruptEncoderWheel(Schedule &schedule, int clockPin, int dataPin,
                            int &value, int limit, int slot) :
         Scheduled(schedule),
-        _delta(_EncoderISR::_delta[slot & 1]),
-        _value(value), _limit(limit) {
-        int s = slot & 1;
-        _EncoderISR::_dataPin[s] = dataPin;
-        _EncoderISR::_delta[s] = 0;
+        _slot(slot < 0 ? 0 : slot % ENCODER_ISR_SLOTS),
+        _value(value), _limit(limit), _lastTravel(0) {
+        _EncoderISR::Slot &s = _EncoderISR::_slot[_slot];
         pinMode(clockPin, INPUT_PULLUP);
         pinMode(dataPin, INPUT_PULLUP);
+        s.clockPin = clockPin;
+        s.dataPin = dataPin;
+#if defined(__AVR__)
+        s.clockPort = portInputRegister(digitalPinToPort(clockPin));
+        s.dataPort = portInputRegister(digitalPinToPort(dataPin));
+        s.clockMask = digitalPinToBitMask(clockPin);
+        s.dataMask = digitalPinToBitMask(dataPin);
+#endif
+        s.position = 0;
+        s.travel = 0;
+        s.errors = 0;
+        s.decoder.begin(_EncoderISR::read(s));
         int interruptPin = digitalPinToInterrupt(clockPin);
-        Serial.print("Setting up encoder slot ");
-        Serial.print(s);
-        Serial.print(" on clock pin ");
-        Serial.print(clockPin);
-        Serial.print(" (interrupt ");
-        Serial.print(interruptPin);
-        Serial.print("), data pin ");
-        Serial.println(dataPin);
+        int dataInterruptPin = digitalPinToInterrupt(dataPin);
+        s.clockOnly = dataInterruptPin == -1;
+        LOG_DEFER2("Encoder slot %d clock pin %d", _slot, clockPin);
+        LOG_DEFER2("Encoder slot %d data pin %d", _slot, dataPin);
         if (interruptPin != -1) {
-            attachInterrupt(interruptPin,
-                            s == 0 ? _EncoderISR::isr0 : _EncoderISR::isr1,
-                            RISING);
-            Serial.println("Interrupt attached successfully");
+            _EncoderISR::Isr isr = _EncoderISR::IsrTable<ENCODER_ISR_SLOTS>::get(_slot);
+            attachInterrupt(interruptPin, isr, CHANGE);
+            if (!s.clockOnly) {
+                attachInterrupt(dataInterruptPin, isr, CHANGE);
+            }
+            LOG_DEFER2("Encoder slot %d interrupts attached (clock only: %d)", _slot, s.clockOnly);
         } else {
-            Serial.println("ERROR: Pin not interrupt-capable!");
+            LOG_DEFER1("ERROR: encoder slot %d clock pin not interrupt-capable!", _slot);
         }
     }
     void poll() override {
-        int d;
-        noInterrupts();
-        d = _delta;
-        _delta = 0;
-        interrupts();
+        long travel = _EncoderISR::travel(_slot);
+        long d = travel - _lastTravel;
+        _lastTravel = travel;
+        _velocity.update(_EncoderISR::position(_slot));
         if (d != 0) {
-            int oldValue = _value;
             _value = constrain(_value + d, 0, _limit);
-            int slot = (&_delta - _EncoderISR::_delta) / sizeof(int);
-            Serial.print("Encoder slot ");
-            Serial.print(slot);
-            Serial.print(" polled: delta=");
-            Serial.print(d);
-            Serial.print(", value ");
-            Serial.print(oldValue);
-            Serial.print(" -> ");
-            Serial.println(_value);
+            LOG_DEFER2("Encoder slot %d polled: delta=%ld", _slot, d);
+            LOG_DEFER2("Encoder slot %d value now %d", _slot, _value);
         }
     }
+    void resolution(EncoderResolution resolution) { _EncoderISR::resolution(_slot, resolution); }
+    void acceleration(const EncoderAccelStep *curve) { _EncoderISR::acceleration(_slot, curve); }
+    long position() const { return _EncoderISR::position(_slot); }
+    long velocity() const { return _velocity.velocity(); }
+    uint16_t errors() const { return _EncoderISR::errors(_slot); }
 };
 
 // Maps encoder position over [0, maxVal], starting at the midpoint.
@@ -239,6 +609,11 @@ public:
         Mapper<int, T>(schedule, _encoderValue, value,
                        0, abs(sensitivity), (T)0, maxVal),
         _encoderValue(abs(sensitivity) / 2) { }
+    using InterruptEncoderWheel::resolution;
+    using InterruptEncoderWheel::acceleration;
+    using InterruptEncoderWheel::position;
+    using InterruptEncoderWheel::velocity;
+    using InterruptEncoderWheel::errors;
 };
 
 template <class T>
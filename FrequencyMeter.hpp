@@ -0,0 +1,318 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <Scheduler.hpp>
+#include <Clock.hpp>
+
+/*
+FrequencyMeter and PeriodMeter measure a digital signal on a pin without
+polling it.  Counter/FrequencyDivider in EdgeDetector.hpp only see edges that
+survive until the next poll(); these use hardware to catch every edge, and
+poll() only reads back a snapshot.
+
+Backends, picked at compile time:
+  ESP32      FrequencyMeter counts edges in a PCNT unit (no CPU per edge).
+  AVR        #define PULSE_CAPTURE_ICP before including this file to timestamp
+             edges with Timer1 input capture on the ICP1 pin (pin 4 on
+             ATmega32u4, pin 8 on ATmega328P).  This takes over Timer1, so
+             analogWrite() on the Timer1 PWM pins stops working.
+  Others     attachInterrupt(CHANGE) + micros().  Used on RA4M1 (all pins),
+             and on AVR/ESP32 when the above don't apply.
+
+Example:
+MainSchedule schedule;
+long hz, periodUs, duty;
+FrequencyMeter freq(schedule, 7, hz);                    // updated every 250ms
+PeriodMeter period(schedule, 3, periodUs, duty, 1);     // duty in 1/1000ths
+void setup() { schedule.begin(); }
+void loop() { schedule.poll(); }
+
+Like InterruptEncoderControl, each capture-based meter needs its own slot.
+There are PULSE_CAPTURE_SLOTS of them (default 2); define it before including
+this file to get more.
+*/
+
+#ifndef PULSE_CAPTURE_SLOTS
+#define PULSE_CAPTURE_SLOTS 2
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/pulse_cnt.h>
+#define PULSE_CAPTURE_ISR_ATTR IRAM_ATTR
+#else
+#define PULSE_CAPTURE_ISR_ATTR
+#endif
+
+#if defined(PULSE_CAPTURE_ICP) && defined(__AVR__)
+#if defined(__AVR_ATmega32U4__)
+#define PULSE_CAPTURE_ICP_PIN 4
+#elif defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+#define PULSE_CAPTURE_ICP_PIN 8
+#endif
+#endif
+
+// Edge timestamps captured in interrupt context.  Times are in ticks of
+// ticksPerSecond so the ICP backend can keep its sub-microsecond resolution.
+namespace _PulseCapture {
+	struct Slot {
+		volatile uint32_t edges;   // rising edges seen
+		volatile uint32_t rise;    // timestamp of the last rising edge
+		volatile uint32_t period;  // ticks between the last two rising edges
+		volatile uint32_t high;    // ticks high of the last complete pulse
+		uint32_t ticksPerSecond;
+		int pin;
+	};
+	Slot _slot[PULSE_CAPTURE_SLOTS];
+
+	inline PULSE_CAPTURE_ISR_ATTR void edge(int s, bool rising, uint32_t now) {
+		Slot &slot = _slot[s];
+		if (rising) {
+			if (slot.edges) {
+				slot.period = now - slot.rise;
+			}
+			slot.rise = now;
+			slot.edges++;
+		} else if (slot.edges) {
+			slot.high = now - slot.rise;
+		}
+	}
+	inline PULSE_CAPTURE_ISR_ATTR void change(int s) {
+		edge(s, digitalRead(_slot[s].pin), micros());
+	}
+	template <int S>
+	void PULSE_CAPTURE_ISR_ATTR isr() { change(S); }
+
+	typedef void (*Isr)();
+	template <int N>
+	struct IsrTable {
+		static Isr get(int s) { return s == N - 1 ? &isr<N - 1> : IsrTable<N - 1>::get(s); }
+	};
+	template <>
+	struct IsrTable<0> {
+		static Isr get(int) { return 0; }
+	};
+
+	inline void snapshot(int s, Slot &out) {
+		noInterrupts();
+		out.edges = _slot[s].edges;
+		out.rise = _slot[s].rise;
+		out.period = _slot[s].period;
+		out.high = _slot[s].high;
+		interrupts();
+		out.ticksPerSecond = _slot[s].ticksPerSecond;
+	}
+
+#ifdef PULSE_CAPTURE_ICP_PIN
+	volatile uint16_t _icpOverflows;
+	int _icpSlot = -1;
+
+	inline bool beginICP(int s) {
+		_icpSlot = s;
+		noInterrupts();
+		TCCR1A = 0;
+		TCCR1B = _BV(ICNC1) | _BV(ICES1) | _BV(CS11); // noise canceller, rising, clk/8
+		TCNT1 = 0;
+		TIFR1 = _BV(ICF1) | _BV(TOV1);
+		TIMSK1 = _BV(ICIE1) | _BV(TOIE1);
+		interrupts();
+		_slot[s].ticksPerSecond = F_CPU / 8;
+		return true;
+	}
+#endif
+
+	// Returns false if the pin can't interrupt.
+	inline bool begin(int s, int pin) {
+		_slot[s].edges = 0;
+		_slot[s].rise = 0;
+		_slot[s].period = 0;
+		_slot[s].high = 0;
+		_slot[s].pin = pin;
+		pinMode(pin, INPUT);
+#ifdef PULSE_CAPTURE_ICP_PIN
+		if (pin == PULSE_CAPTURE_ICP_PIN) {
+			return beginICP(s);
+		}
+#endif
+		_slot[s].ticksPerSecond = 1000000UL;
+		int interrupt = digitalPinToInterrupt(pin);
+		if (interrupt == -1) {
+			return false;
+		}
+		attachInterrupt(interrupt, IsrTable<PULSE_CAPTURE_SLOTS>::get(s), CHANGE);
+		return true;
+	}
+}
+
+#ifdef PULSE_CAPTURE_ICP_PIN
+ISR(TIMER1_OVF_vect) {
+	_PulseCapture::_icpOverflows++;
+}
+
+ISR(TIMER1_CAPT_vect) {
+	uint16_t low = ICR1;
+	uint16_t high = _PulseCapture::_icpOverflows;
+	// Overflow pending but not yet serviced, and the capture happened after it.
+	if ((TIFR1 & _BV(TOV1)) && low < 0x8000) {
+		high++;
+	}
+	bool rising = TCCR1B & _BV(ICES1);
+	TCCR1B ^= _BV(ICES1);
+	TIFR1 = _BV(ICF1); // changing ICES1 can raise a spurious capture
+	_PulseCapture::edge(_PulseCapture::_icpSlot, rising, ((uint32_t)high << 16) | low);
+}
+#endif
+
+/*
+FrequencyMeter writes the input frequency in Hz every gateMs.
+Capture backends use reciprocal counting (edges / time between the first and
+last edge of the gate), so the result is exact to the timer tick and doesn't
+depend on when poll() happens to run.  The PCNT backend divides the hardware
+count by the gate time measured with micros().
+*/
+class FrequencyMeter : private Scheduled {
+	long &_frequency;
+	long _gateMs;
+	Timer _gate;
+	uint32_t _lastEdges;
+	uint32_t _lastTime;
+	bool _primed;
+#if defined(ARDUINO_ARCH_ESP32)
+	pcnt_unit_handle_t _unit;
+	pcnt_channel_handle_t _channel;
+#else
+	int _slot;
+#endif
+public:
+	FrequencyMeter(Schedule &schedule, int pin, long &frequency, long gateMs = 250, int slot = 0) :
+		Scheduled(schedule), _frequency(frequency), _gateMs(gateMs), _gate(gateMs),
+		_lastEdges(0), _lastTime(0), _primed(false) {
+		_frequency = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+		(void)slot;
+		_unit = NULL;
+		_channel = NULL;
+		pcnt_unit_config_t unitConfig = {};
+		unitConfig.low_limit = -1;
+		unitConfig.high_limit = 32767;
+		unitConfig.flags.accum_count = 1;
+		if (pcnt_new_unit(&unitConfig, &_unit) != ESP_OK) {
+			_unit = NULL;
+			return;
+		}
+		pcnt_glitch_filter_config_t filter = {};
+		filter.max_glitch_ns = 100;
+		pcnt_unit_set_glitch_filter(_unit, &filter);
+		pcnt_chan_config_t channelConfig = {};
+		channelConfig.edge_gpio_num = pin;
+		channelConfig.level_gpio_num = -1;
+		pcnt_new_channel(_unit, &channelConfig, &_channel);
+		pcnt_channel_set_edge_action(_channel, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_HOLD);
+		// accum_count only extends past high_limit if there's a watch point on it.
+		pcnt_unit_add_watch_point(_unit, unitConfig.high_limit);
+		pcnt_unit_enable(_unit);
+		pcnt_unit_clear_count(_unit);
+		pcnt_unit_start(_unit);
+#else
+		_slot = slot < 0 ? 0 : slot % PULSE_CAPTURE_SLOTS;
+		_PulseCapture::begin(_slot, pin);
+#endif
+	}
+	void poll() {
+		if (!_gate.expired()) {
+			return;
+		}
+		_gate.reset(_gateMs);
+#if defined(ARDUINO_ARCH_ESP32)
+		if (!_unit) {
+			return;
+		}
+		int count = 0;
+		pcnt_unit_get_count(_unit, &count);
+		uint32_t edges = (uint32_t)count;
+		uint32_t now = micros();
+		uint32_t ticksPerSecond = 1000000UL;
+#else
+		_PulseCapture::Slot s;
+		_PulseCapture::snapshot(_slot, s);
+		uint32_t edges = s.edges;
+		uint32_t now = s.rise;
+		uint32_t ticksPerSecond = s.ticksPerSecond;
+#endif
+		uint32_t dEdges = edges - _lastEdges;
+		uint32_t dTime = now - _lastTime;
+		if (_primed && dEdges && dTime) {
+			_frequency = (long)(((uint64_t)dEdges * ticksPerSecond + dTime / 2) / dTime);
+		} else if (_primed) {
+			_frequency = 0;
+		}
+#if !defined(ARDUINO_ARCH_ESP32)
+		// Reciprocal counting needs an edge to anchor the next window.
+		if (!edges) {
+			return;
+		}
+#endif
+		_lastEdges = edges;
+		_lastTime = now;
+		_primed = true;
+	}
+};
+
+/*
+PeriodMeter writes the period of the last complete cycle in microseconds and
+the duty cycle in tenths of a percent (0..1000).  Both fall to 0 if no edge
+arrives within timeoutMs.
+*/
+class PeriodMeter : private Scheduled {
+	long &_periodUs;
+	long &_dutyPermille;
+	int _slot;
+	long _timeoutMs;
+	Timer _timeout;
+	uint32_t _lastEdges;
+public:
+	PeriodMeter(Schedule &schedule, int pin, long &periodUs, long &dutyPermille, int slot = 0, long timeoutMs = 1000) :
+		Scheduled(schedule), _periodUs(periodUs), _dutyPermille(dutyPermille),
+		_slot(slot < 0 ? 0 : slot % PULSE_CAPTURE_SLOTS), _timeoutMs(timeoutMs), _timeout(timeoutMs), _lastEdges(0) {
+		_periodUs = 0;
+		_dutyPermille = 0;
+		_PulseCapture::begin(_slot, pin);
+	}
+	void poll() {
+		_PulseCapture::Slot s;
+		_PulseCapture::snapshot(_slot, s);
+		if (s.edges != _lastEdges) {
+			_lastEdges = s.edges;
+			_timeout.reset(_timeoutMs);
+			if (s.period) {
+				_periodUs = (long)((uint64_t)s.period * 1000000UL / s.ticksPerSecond);
+				_dutyPermille = s.high < s.period ? (long)((uint64_t)s.high * 1000 / s.period) : 1000;
+			}
+		} else if (_timeout.expired()) {
+			_periodUs = 0;
+			_dutyPermille = 0;
+		}
+	}
+};
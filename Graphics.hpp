@@ -51,12 +51,35 @@ struct Rect : public Pos<T>, public Size<T> {
   T top() const { return this->y; }
   T right() const { return this->x + this->width; }
   T bottom() const { return this->y + this->height; }
+  bool empty() const { return this->width <= 0 || this->height <= 0; }
+  // Grows this rect to cover both.
+  void unite(const Rect<T> &other) {
+    if (other.empty()) return;
+    if (empty()) { *this = other; return; }
+    T r = max(right(), other.right());
+    T b = max(bottom(), other.bottom());
+    this->x = min(this->x, other.x);
+    this->y = min(this->y, other.y);
+    this->width = r - this->x;
+    this->height = b - this->y;
+  }
 };
 
+template <class TDisplay> class MainWindow;
+
+// Drawables that can say where they draw (bounds) and whether that has
+// changed let MainWindow redraw and send only the parts of the screen that
+// moved.  The defaults mean "don't know", which redraws everything.
 template <class TDisplay>
 class Drawable {
+  friend class MainWindow<TDisplay>;
+  Rect<int16_t> _drawn;  // bounds as of the last frame, kept by MainWindow
 public:
   virtual void draw(TDisplay &display) = 0;
+  // Bounding box of what draw() covers.  Return false if it isn't known.
+  virtual bool bounds(Rect<int16_t> &rect) { return false; }
+  // Whether the next draw() would differ from the last one.
+  virtual bool changed() { return true; }
 };
 
 template <class TDisplay>
@@ -75,29 +98,351 @@ public:
       this->item(i)->draw(display);
     }
   }
+  bool bounds(Rect<int16_t> &rect) {
+    rect = Rect<int16_t>();
+    const int count = this->length();
+    for (int i = 0; i < count; i++) {
+      Rect<int16_t> item;
+      if (!this->item(i)->bounds(item)) return false;
+      rect.unite(item);
+    }
+    return true;
+  }
+  bool changed() {
+    const int count = this->length();
+    for (int i = 0; i < count; i++) {
+      if (this->item(i)->changed()) return true;
+    }
+    return false;
+  }
+};
+
+// Running timings for frames or transfers, in microseconds.
+struct FrameStats {
+  unsigned long count;
+  unsigned long lastMicros;
+  unsigned long maxMicros;
+  unsigned long totalMicros;
+  FrameStats() { reset(); }
+  void reset() { count = 0; lastMicros = 0; maxMicros = 0; totalMicros = 0; }
+  void add(unsigned long us) {
+    count++;
+    lastMicros = us;
+    if (us > maxMicros) maxMicros = us;
+    totalMicros += us;
+  }
+  unsigned long averageMicros() const { return count ? totalMicros / count : 0; }
+};
+
+// Sends a range of columns [col0, col1] of one 8-pixel page of a
+// framebuffer to the panel.  The framebuffer is laid out a page at a time,
+// one byte per column, like Adafruit_SSD1306::getBuffer().
+class PageSink {
+public:
+  virtual void sendPage(const uint8_t *frame, uint8_t page, uint8_t col0, uint8_t col1) = 0;
+  // Called at the end of every update, whether or not any pages were sent.
+  virtual void endFrame() { }
+};
+
+// Include Adafruit_SSD1306.h before this file to get SSD1306PageSink.
+#ifdef SSD1306_PAGEADDR
+/*
+Partial updates for an I2C SSD1306 driven by Adafruit_SSD1306.  Each page
+costs one 8-byte addressing transaction plus its data, instead of the whole
+framebuffer.  Assumes rotation 0.  Adafruit_SSD1306::display() sets its own
+full-screen window, so the two can be mixed.
+*/
+template <class TDisplay>
+class SSD1306PageSink : public PageSink {
+  static const uint8_t Chunk = 31; // data bytes per transaction, after the 0x40 control byte
+  TDisplay &_display;
+  TwoWire &_wire;
+  uint8_t _address;
+  unsigned long _bytes;
+public:
+  SSD1306PageSink(TDisplay &display, uint8_t address = 0x3C, TwoWire &wire = Wire) :
+    _display(display), _wire(wire), _address(address), _bytes(0) { }
+  void sendPage(const uint8_t *frame, uint8_t page, uint8_t col0, uint8_t col1) {
+    _wire.beginTransmission(_address);
+    _wire.write((uint8_t)0x00);
+    _wire.write((uint8_t)SSD1306_PAGEADDR);
+    _wire.write(page);
+    _wire.write(page);
+    _wire.write((uint8_t)SSD1306_COLUMNADDR);
+    _wire.write(col0);
+    _wire.write(col1);
+    _wire.endTransmission();
+    _bytes += 8;
+    const uint8_t *data = frame + page * _display.width() + col0;
+    int n = col1 - col0 + 1;
+    while (n > 0) {
+      int chunk = n < Chunk ? n : Chunk;
+      _wire.beginTransmission(_address);
+      _wire.write((uint8_t)0x40);
+      _wire.write(data, chunk);
+      _wire.endTransmission();
+      _bytes += chunk + 1;
+      data += chunk;
+      n -= chunk;
+    }
+  }
+  // Bytes sent on the bus so far (not counting I2C address bytes).
+  unsigned long bytes() const { return _bytes; }
+};
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+/*
+Double buffering for any PageSink.  MainWindow draws into the display's own
+buffer (the back buffer).  At the end of a frame the changed pages are copied
+into a front buffer and a FreeRTOS task streams them through the wrapped
+sink, so the loop goes straight back to polling input.  If the last frame is
+still going out, the new one waits: its page ranges are merged with the next
+frame's and copied once the task is done.  The copy only ever happens between
+frames, so the panel never gets half a frame.
+
+The wrapped sink's bus belongs to the task while it runs; don't talk to the
+same display from the loop.  If begin() fails (no memory, no task) pages go
+straight to the wrapped sink.
+
+SSD1306PageSink<Adafruit_SSD1306> pages(display);
+BackgroundPageSink background(pages, SCREEN_WIDTH, SCREEN_HEIGHT / 8);
+void setup() {
+  display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+  background.begin();
+  window.pageSink(background);
+  schedule.begin();
+}
+*/
+class BackgroundPageSink : public PageSink {
+  static const int MaxPages = 8;
+  PageSink &_inner;
+  uint16_t _width;
+  uint8_t _pages;
+  uint8_t *_front;
+  const uint8_t *_back;
+  TaskHandle_t _task;
+  volatile bool _busy;
+  int16_t _pending0[MaxPages];  // marked since the last copy
+  int16_t _pending1[MaxPages];
+  int16_t _send0[MaxPages];     // being sent by the task
+  int16_t _send1[MaxPages];
+  FrameStats _transfers;
+  unsigned long _deferred;
+public:
+  BackgroundPageSink(PageSink &inner, uint16_t width, uint8_t pages) :
+    _inner(inner), _width(width), _pages(pages < MaxPages ? pages : MaxPages),
+    _front(NULL), _back(NULL), _task(NULL), _busy(false), _deferred(0) {
+    clearPending();
+  }
+  bool begin(BaseType_t core = 0, UBaseType_t priority = 1) {
+    if (_task) return true;
+    // DMA-capable, so an SPI sink can hand it straight to the driver.
+    _front = (uint8_t *)heap_caps_malloc(_width * _pages, MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
+    if (!_front) return false;
+    if (xTaskCreatePinnedToCore(run, "frame", 4096, this, priority, &_task, core) != pdPASS) {
+      heap_caps_free(_front);
+      _front = NULL;
+      _task = NULL;
+      return false;
+    }
+    return true;
+  }
+  void sendPage(const uint8_t *frame, uint8_t page, uint8_t col0, uint8_t col1) {
+    if (!_task) {
+      _inner.sendPage(frame, page, col0, col1);
+      return;
+    }
+    if (page >= _pages) return;
+    _back = frame;
+    if (col0 < _pending0[page]) _pending0[page] = col0;
+    if (col1 > _pending1[page]) _pending1[page] = col1;
+  }
+  void endFrame() {
+    if (!_task) {
+      _inner.endFrame();
+      return;
+    }
+    if (!hasPending()) return;
+    if (_busy) {
+      _deferred++;
+      return;
+    }
+    for (int p = 0; p < _pages; p++) {
+      _send0[p] = _pending0[p];
+      _send1[p] = _pending1[p];
+      if (_send0[p] <= _send1[p]) {
+        int offset = p * _width + _send0[p];
+        memcpy(_front + offset, _back + offset, _send1[p] - _send0[p] + 1);
+      }
+    }
+    clearPending();
+    _busy = true;
+    xTaskNotifyGive(_task);
+  }
+  // True while the task is sending a frame.
+  bool busy() const { return _busy; }
+  // Time the task spent sending each frame.
+  const FrameStats &transfers() const { return _transfers; }
+  // Frames that had to wait for the previous one to finish.
+  unsigned long deferred() const { return _deferred; }
+private:
+  void clearPending() {
+    for (int p = 0; p < MaxPages; p++) {
+      _pending0[p] = MAX_INT;
+      _pending1[p] = -1;
+    }
+  }
+  bool hasPending() const {
+    for (int p = 0; p < _pages; p++) {
+      if (_pending0[p] <= _pending1[p]) return true;
+    }
+    return false;
+  }
+  static void run(void *self) {
+    ((BackgroundPageSink *)self)->transferLoop();
+  }
+  void transferLoop() {
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      unsigned long start = micros();
+      for (int p = 0; p < _pages; p++) {
+        if (_send0[p] <= _send1[p]) {
+          _inner.sendPage(_front, p, _send0[p], _send1[p]);
+        }
+      }
+      _inner.endFrame();
+      _transfers.add(micros() - start);
+      _busy = false;
+    }
+  }
 };
+#endif
+
+/*
+Drives an Adafruit_GFX-compatible display at a fixed refresh rate.
+Add Drawable objects via add(); they are drawn in registration order each tick.
+
+With a PageSink set, only what changed goes to the panel.  For each changed
+drawable the pages under its old and new bounds are marked, those bands
+are cleared in the framebuffer, everything is redrawn (drawing into RAM
+is cheap, the bus isn't), and just the marked column range of each page is
+sent.  A changed drawable without bounds means every page is sent.  Without
+a sink each frame is a full display().
 
-// Drives an Adafruit_GFX-compatible display at a fixed refresh rate.
-// Add Drawable objects via add(); they are drawn in registration order each tick.
+stats() times each frame that was drawn, including the send unless the sink
+is a BackgroundPageSink.
+*/
 template <class TDisplay>
 class MainWindow : public Clock, private EdgeDetectorBase {
+  static const int MaxPages = 8;
   TDisplay &_display;
   long _clockHigh = 25;
   long _clockLow = 25;
   bool _clockValue;
   List<Drawable<TDisplay>*> _items;
+  PageSink *_sink;
+  bool _hasFrame;
+  int16_t _col0[MaxPages];
+  int16_t _col1[MaxPages];
+  FrameStats _stats;
 public:
   MainWindow(Schedule &schedule, TDisplay &display) :
     Clock(schedule, _clockLow, _clockHigh, _clockValue),
-    EdgeDetectorBase(schedule, _clockValue), _display(display) { }
+    EdgeDetectorBase(schedule, _clockValue), _display(display), _sink(0), _hasFrame(false) { }
   void add(Drawable<TDisplay> *item) { _items.add(item); }
+  void pageSink(PageSink &sink) { _sink = &sink; }
+  // Time between frames; the default is 50ms.  16 gives about 60 fps.
+  void framePeriod(long ms) {
+    _clockHigh = ms / 2;
+    _clockLow = ms - _clockHigh;
+  }
+  // Forces the next frame to be sent in full.
+  void invalidate() { _hasFrame = false; }
+  const FrameStats &stats() const { return _stats; }
   void update() {
-    _display.clearDisplay();
-    for (int i = 0; i < _items.length(); i++) {
-      _items[i]->draw(_display);
+    unsigned long start = micros();
+    if (!_sink) {
+      _display.clearDisplay();
+      drawAll();
+      _display.display();
+      _stats.add(micros() - start);
+      return;
+    }
+    int pages = pageCount();
+    if (!_hasFrame || !markChanges()) {
+      _display.clearDisplay();
+      drawAll();
+      for (int p = 0; p < pages; p++) {
+        _sink->sendPage(_display.getBuffer(), p, 0, _display.width() - 1);
+      }
+      _sink->endFrame();
+      _hasFrame = true;
+      _stats.add(micros() - start);
+      return;
+    }
+    bool any = false;
+    for (int p = 0; p < pages; p++) {
+      if (_col0[p] <= _col1[p]) {
+        _display.fillRect(_col0[p], p * 8, _col1[p] - _col0[p] + 1, 8, 0);
+        any = true;
+      }
+    }
+    if (any) {
+      drawAll();
+      for (int p = 0; p < pages; p++) {
+        if (_col0[p] <= _col1[p]) {
+          _sink->sendPage(_display.getBuffer(), p, _col0[p], _col1[p]);
+        }
+      }
+    }
+    _sink->endFrame();
+    if (any) {
+      _stats.add(micros() - start);
     }
-    _display.display();
   }
   void onRisingEdge() { update(); }
   void onFallingEdge() { }
+private:
+  int pageCount() const {
+    int pages = (_display.height() + 7) / 8;
+    return pages < MaxPages ? pages : MaxPages;
+  }
+  void drawAll() {
+    for (int i = 0; i < _items.length(); i++) {
+      Drawable<TDisplay> *item = _items[i];
+      item->draw(_display);
+      if (!item->bounds(item->_drawn)) {
+        item->_drawn = Rect<int16_t>();
+      }
+    }
+  }
+  // Returns false if a full frame is needed.
+  bool markChanges() {
+    for (int p = 0; p < MaxPages; p++) {
+      _col0[p] = MAX_INT;
+      _col1[p] = -1;
+    }
+    for (int i = 0; i < _items.length(); i++) {
+      Drawable<TDisplay> *item = _items[i];
+      if (!item->changed()) continue;
+      Rect<int16_t> now;
+      if (!item->bounds(now)) return false;
+      mark(item->_drawn);
+      mark(now);
+    }
+    return true;
+  }
+  void mark(const Rect<int16_t> &rect) {
+    if (rect.empty()) return;
+    int16_t x0 = max(rect.left(), (int16_t)0);
+    int16_t x1 = min(rect.right(), (int16_t)_display.width()) - 1;
+    int16_t y0 = max(rect.top(), (int16_t)0);
+    int16_t y1 = min(rect.bottom(), (int16_t)_display.height()) - 1;
+    if (x0 > x1 || y0 > y1) return;
+    for (int p = y0 / 8; p <= y1 / 8 && p < MaxPages; p++) {
+      if (x0 < _col0[p]) _col0[p] = x0;
+      if (x1 > _col1[p]) _col1[p] = x1;
+    }
+  }
 };
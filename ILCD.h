@@ -73,6 +73,8 @@ public:
     virtual void autoscroll() = 0;
     virtual void noAutoscroll() = 0;
 	virtual void setCursor(uint8_t, uint8_t);
+	// Custom character slot 0-7, 8 rows of 5 bits.  Displays without CGRAM ignore it.
+	virtual void createChar(uint8_t, uint8_t[]) { }
 };
 
 class IKeypad {
@@ -81,3 +83,31 @@ public:
     virtual uint8_t read() = 0;
     virtual void clear() = 0;
 };
+
+// Key codes collected ahead of IKeypad::read(), oldest first.  TSize is a
+// power of two up to 128; keys arriving when it's full are dropped.
+template <uint8_t TSize = 16>
+class KeyQueue {
+    uint8_t _keys[TSize];
+    uint8_t _head;  // free running; masked on use
+    uint8_t _tail;
+    uint8_t _dropped;
+public:
+    KeyQueue() : _head(0), _tail(0), _dropped(0) { }
+    bool empty() const { return _head == _tail; }
+    uint8_t length() const { return (uint8_t)(_head - _tail); }
+    uint8_t dropped() const { return _dropped; }
+    bool push(uint8_t key) {
+        if (length() >= TSize) {
+            _dropped++;
+            return false;
+        }
+        _keys[_head++ & (TSize - 1)] = key;
+        return true;
+    }
+    // 0 when empty.
+    uint8_t pop() {
+        return empty() ? 0 : _keys[_tail++ & (TSize - 1)];
+    }
+    void clear() { _tail = _head; }
+};
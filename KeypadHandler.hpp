@@ -114,14 +114,114 @@ public:
   }
 };
 
+/* KeyDispatchTable finds the binding for a key by indexing a table with the
+ * key code, so dispatch costs the same however many keys are bound, where
+ * KeypadKeyHandlerComposite asks each handler in turn.  A binding is either
+ * a KeypadKeyHandler or a plain function.
+ *
+ * Bindings live in layers (a menu layer and a game layer, say), and layer()
+ * switches between them in one assignment.  A key not bound in the active
+ * layer falls back to layer 0, then to the fallback handler if there is one,
+ * e.g. a MenuKeypadController so edit keys still reach the menu.
+ *
+ * Keys TFirst .. TFirst+TSize-1 can be bound; the default covers the LK204
+ * codes 'A'..'`', and TSize = 256 with TFirst = 0 covers every key code.  The table costs TLayers * TSize bytes, plus 4 bytes (on
+ * AVR) for each of the TBindings distinct handlers or functions.
+ *
+ * enum { MenuLayer, GameLayer };
+ * KeyDispatchTable<2> keys;
+ * void setup() {
+ *   keys.bind(GameLayer, KeypadKey_2, onUp);
+ *   keys.bind(GameLayer, KeypadKey_8, onDown);
+ *   keys.bind(MenuLayer, KeypadKey_D, backToGame);
+ *   keys.fallback(&menuKeys);
+ *   keys.layer(GameLayer);
+ * }
+ * KeypadHandler keypadHandler(schedule, keypad, keys);
+ */
+template <uint8_t TLayers = 2, uint16_t TSize = 32, char TFirst = 'A', uint8_t TBindings = 16>
+class KeyDispatchTable : public KeypadKeyHandler {
+  struct Binding {
+    KeypadKeyHandler *handler;
+    void (*function)(char ch);
+  };
+  Binding _bindings[TBindings];
+  uint8_t _bindingCount;
+  uint8_t _table[TLayers][TSize]; // binding index + 1, 0 if unbound
+  uint8_t _layer;
+  KeypadKeyHandler *_fallback;
+
+  static int slot(char ch) {
+    uint16_t i = (uint8_t)((uint8_t)ch - (uint8_t)TFirst);
+    return i < TSize ? i : -1;
+  }
+  bool bind(uint8_t layer, char key, KeypadKeyHandler *handler, void (*function)(char ch)) {
+    int i = slot(key);
+    if (layer >= TLayers || i < 0) return false;
+    uint8_t b = 0;
+    while (b < _bindingCount && (_bindings[b].handler != handler || _bindings[b].function != function)) b++;
+    if (b == _bindingCount) {
+      if (_bindingCount >= TBindings) return false;
+      _bindings[b].handler = handler;
+      _bindings[b].function = function;
+      _bindingCount++;
+    }
+    _table[layer][i] = b + 1;
+    return true;
+  }
+  bool dispatch(uint8_t entry, char ch) {
+    const Binding &b = _bindings[entry - 1];
+    if (b.function) {
+      b.function(ch);
+      return true;
+    }
+    return b.handler->handle_key(ch);
+  }
+public:
+  KeyDispatchTable() : _bindingCount(0), _layer(0), _fallback(0) {
+    for (uint8_t l = 0; l < TLayers; l++) {
+      for (uint16_t i = 0; i < TSize; i++) {
+        _table[l][i] = 0;
+      }
+    }
+  }
+  // False if the key is out of range or all TBindings are used.
+  bool bind(uint8_t layer, char key, KeypadKeyHandler &handler) { return bind(layer, key, &handler, 0); }
+  bool bind(uint8_t layer, char key, void (*function)(char ch)) { return bind(layer, key, 0, function); }
+  void unbind(uint8_t layer, char key) {
+    int i = slot(key);
+    if (layer < TLayers && i >= 0) _table[layer][i] = 0;
+  }
+  void layer(uint8_t layer) { if (layer < TLayers) _layer = layer; }
+  uint8_t layer() const { return _layer; }
+  void fallback(KeypadKeyHandler *handler) { _fallback = handler; }
+
+  virtual bool handle_key(char ch) {
+    int i = slot(ch);
+    if (i >= 0) {
+      uint8_t entry = _table[_layer][i];
+      if (!entry) entry = _table[0][i];
+      if (entry) return dispatch(entry, ch);
+    }
+    return _fallback ? _fallback->handle_key(ch) : false;
+  }
+};
+
 class KeypadHandler : public Scheduled {
+  static const uint8_t MaxKeysPerPoll = 4;
   IKeypad &_keypad;
   KeypadKeyHandler &_keyHandler;
 public:
   KeypadHandler(Schedule &schedule, IKeypad &keypad, KeypadKeyHandler &keyHandler) : 
     Scheduled(schedule), _keypad(keypad), _keyHandler(keyHandler) { }
+  // Handles every key the keypad has ready; an idle poll dispatches nothing.
   void poll() {
-    char ch = _keypad.read();
-    _keyHandler.handle_key(ch);
+    for (uint8_t i = 0; i < MaxKeysPerPoll; i++) {
+      char ch = _keypad.read();
+      if (!ch) {
+        return;
+      }
+      _keyHandler.handle_key(ch);
+    }
   }
 };
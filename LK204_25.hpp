@@ -40,49 +40,185 @@ SOFTWARE.
  * void loop() { }
 */
 
-class LK204_25_Base {
-    static const uint8_t CommandPrefix = 0xFE;
-    static const uint8_t WriteDelay = 1;
-    static const uint8_t CommandDelay = 5 - WriteDelay;
+#ifndef LK204_BATCH_SIZE
+#define LK204_BATCH_SIZE 32 // bytes per I2C transaction (Wire's buffer on AVR)
+#endif
+static_assert(LK204_BATCH_SIZE >= 11, "LK204_BATCH_SIZE must hold a createChar() command (11 bytes)");
+
+/* What the LCD and keypad drivers share: the module's address, sending one
+ * transaction with retries while the module is busy, and the error count.
+ * A busy module NACKs its address, so that's retried briefly until ACKed.
+ */
+class LK204_25_Device {
+    static const uint8_t BusyRetries = 20;
     const uint8_t _address;
+    uint16_t _errors;
 
 public:
-    LK204_25_Base(uint8_t addr) : _address(addr) { }
+    LK204_25_Device(uint8_t addr) : _address(addr), _errors(0) { }
+    // Transactions that failed after retries.
+    uint16_t errors() const { return _errors; }
 
 protected:
+    static const uint8_t CommandPrefix = 0xFE;
+    static const uint8_t BusyRetryMicros = 100;
+
     uint8_t getAddr() { return _address; }
+    void error() { _errors++; }
+
+    // Returns Wire's status: 0 sent, 2 address NACKed, 3 data NACKed.
+    uint8_t transmit(const uint8_t *bytes, uint8_t n) {
+        uint8_t status = transmitOnce(bytes, n);
+        for (uint8_t retry = 0; status == 2 && retry < BusyRetries; retry++) {
+            delayMicroseconds(BusyRetryMicros);
+            status = transmitOnce(bytes, n);
+        }
+        return status;
+    }
+
+    // Unbatched, for the keypad.
     void send_command(uint8_t cmd) {
+        const uint8_t bytes[] = { CommandPrefix, cmd };
+        if (transmit(bytes, sizeof(bytes)) != 0) {
+            error();
+        }
+    }
+
+private:
+    uint8_t transmitOnce(const uint8_t *bytes, uint8_t n) {
         Wire.beginTransmission(_address);
-        Wire.write(CommandPrefix);
-        Wire.write(cmd);
-        Wire.endTransmission();
-        delay(CommandDelay);
+        Wire.write(bytes, n);
+        return Wire.endTransmission();
+    }
+};
+
+/* Output is packed into as few I2C transactions as possible instead of one
+ * per byte.  Text and commands are queued and sent when the batch is full or
+ * a call finishes; setCursor() is held back so it goes out with the text that
+ * follows it, which makes a cursor move plus a 20 character row a single
+ * transaction.  Call flush() after a trailing setCursor() if the cursor is
+ * visible.
+ *
+ * There are no fixed delays; a busy display is retried as above.  If the
+ * display NACKs data partway through, its buffer overran: the limit is
+ * halved, and what hasn't been ACKed is sent again in pieces of the new
+ * size, so the display doesn't drift from what the caller thinks it wrote.
+ * Wire doesn't say how much of a NACKed piece landed, so that piece is
+ * repeated whole; text that follows a setCursor() in the same piece just
+ * overwrites itself.  A batch bigger than the limit (a createChar() after
+ * the limit has dropped to 8) goes out the same way, in pieces.  Only
+ * clear() has a settle time, and the next transaction waits out just what's
+ * left of it.
+ */
+class LK204_25_Base : public LK204_25_Device {
+    static const uint8_t OverrunRetries = 3;
+    static const uint8_t MinBatch = 8;
+    uint8_t _batch[LK204_BATCH_SIZE];
+    uint8_t _length;
+    uint8_t _limit;
+    unsigned long _settleStart;
+    unsigned int _settleMicros;
+
+public:
+    LK204_25_Base(uint8_t addr) : LK204_25_Device(addr), _length(0), _limit(LK204_BATCH_SIZE),
+        _settleStart(0), _settleMicros(0) { }
+
+protected:
+    void send_command(uint8_t cmd) {
+        queue_command(cmd);
+        send();
     }
 
     void send_command_2(uint8_t cmd, uint8_t val) {
-        Wire.beginTransmission(_address);
-        Wire.write(CommandPrefix);
-        Wire.write(cmd);
-        Wire.write(val);
-        Wire.endTransmission();
-        delay(CommandDelay);
+        const uint8_t bytes[] = { CommandPrefix, cmd, val };
+        queue(bytes, sizeof(bytes));
+        send();
+    }
+
+    void send_command_data(uint8_t cmd, uint8_t arg, const uint8_t *data, uint8_t size) {
+        uint8_t bytes[3 + 8];
+        bytes[0] = CommandPrefix;
+        bytes[1] = cmd;
+        bytes[2] = arg;
+        if (size > 8) size = 8;
+        memcpy(bytes + 3, data, size);
+        queue(bytes, 3 + size);
+        send();
     }
 
+    // Queued only; see above.
     void send_command_3(uint8_t cmd, uint8_t arg1, uint8_t arg2) {
-        Wire.beginTransmission(_address);
-        Wire.write(CommandPrefix);
-        Wire.write(cmd);
-        Wire.write(arg1);
-        Wire.write(arg2);
-        Wire.endTransmission();
-        delay(CommandDelay);
+        const uint8_t bytes[] = { CommandPrefix, cmd, arg1, arg2 };
+        queue(bytes, sizeof(bytes));
     }
 
     void send_byte(uint8_t b) {
-        Wire.beginTransmission(_address);
-        Wire.write(b);
-        Wire.endTransmission();
-        delay(WriteDelay);
+        queue(&b, 1);
+        send();
+    }
+
+    void send_bytes(const uint8_t *bytes, size_t size) {
+        while (size) {
+            if (_length >= _limit) {
+                send();
+            }
+            for (; size && _length < _limit; size--) {
+                _batch[_length++] = *bytes++;
+            }
+        }
+        send();
+    }
+
+    void queue_command(uint8_t cmd) {
+        const uint8_t bytes[] = { CommandPrefix, cmd };
+        queue(bytes, sizeof(bytes));
+    }
+
+    // Holds off the next transaction while the display works through a slow command.
+    void settle(unsigned int us) {
+        _settleStart = micros();
+        _settleMicros = us;
+    }
+
+    // Sends whatever is queued, as one transaction unless it's over the limit.
+    void send() {
+        if (!_length) {
+            return;
+        }
+        while (_settleMicros && micros() - _settleStart < _settleMicros) { }
+        _settleMicros = 0;
+        uint8_t sent = 0;
+        uint8_t overruns = 0;
+        uint8_t status = 0;
+        while (sent < _length) {
+            uint8_t n = _length - sent < _limit ? _length - sent : _limit;
+            status = transmit(_batch + sent, n);
+            if (status == 0) {
+                sent += n;
+            } else if (status == 3 && overruns++ < OverrunRetries) {
+                if (_limit / 2 >= MinBatch) {
+                    _limit /= 2;
+                }
+                delayMicroseconds(BusyRetryMicros); // let the display drain its buffer
+            } else {
+                break;
+            }
+        }
+        if (status != 0) {
+            error();
+        }
+        _length = 0;
+    }
+
+private:
+    // A command that won't fit goes whole into the next transaction.
+    void queue(const uint8_t *bytes, uint8_t n) {
+        if (_length + n > _limit) {
+            send();
+        }
+        for (uint8_t i = 0; i < n; i++) {
+            _batch[_length++] = bytes[i];
+        }
     }
 };
 
@@ -102,6 +238,8 @@ class LK204_25_LCD : public ILCD, private LK204_25_Base {
     static const uint8_t Command_NoCursorUnderline = 'K';
     static const uint8_t Command_CursorBlock = 'S';
     static const uint8_t Command_NoCursorBlock = 'T';
+    static const uint8_t Command_CustomChar = 'N';
+    static const unsigned int ClearMicros = 2000;
     const uint8_t _cols;
     const uint8_t _rows;
 public:
@@ -114,7 +252,10 @@ public:
         home();
     }
     void home() { send_command(Command_Home); }
-    void clear() { send_command(Command_Clear); }
+    void clear() {
+        send_command(Command_Clear);
+        settle(ClearMicros);
+    }
     void lineWrap(bool on) { send_command(on ? Command_LineWrap : Command_NoLineWrap); }
     void autoScroll(bool on) { send_command(on ? Command_AutoScroll : Command_NoAutoScroll); }
     void backspace() { send_command(Command_Backspace); }
@@ -123,6 +264,7 @@ public:
     void setCursor(uint8_t col, uint8_t row) { send_command_3(Command_SetCursor, col+1, row+1); }
     void cursorUnderline(bool on) { send_command(on ? Command_CursorUnderline : Command_NoCursorUnderline); }
     void cursorBlock(bool on) { send_command(on ? Command_CursorBlock : Command_NoCursorBlock); }
+    void createChar(uint8_t slot, uint8_t bitmap[]) { send_command_data(Command_CustomChar, slot & 7, bitmap, 8); }
 	void blink_on() { cursorBlock(true); }
 	void blink_off() { cursorBlock(false); }
 	void cursor_on() { blink_on(); }
@@ -148,6 +290,10 @@ public:
     void noBacklight() { backlight_off(); }
 
     virtual size_t write(uint8_t c) { send_byte(c); return 1; }
+    virtual size_t write(const uint8_t *buffer, size_t size) { send_bytes(buffer, size); return size; }
+    using Print::write;
+    virtual void flush() { send(); }
+    using LK204_25_Base::errors;
 
     int getCols() { return _cols; }
     int getRows() { return _rows; }
@@ -160,8 +306,16 @@ public:
  * F G H I
  * K L M N
  * P Q R S
+ *
+ * read() hands out keys from a queue and only goes to the bus when the queue
+ * is empty and pollMs has passed since the last bus read, so a loop that
+ * calls it constantly costs one I2C round trip every pollMs instead of one
+ * per call.  The module itself buffers keys between reads, so none are lost.
+ * A key read with the top bit set has more behind it, and those are
+ * collected in the same visit.  pollMs = 0 reads the bus on every empty
+ * call, as before.
  */
-class LK204_25_Keypad : public IKeypad, private LK204_25_Base {
+class LK204_25_Keypad : public IKeypad, private LK204_25_Device {
     static const uint8_t DefaultAddress = 0x2E;
     static const uint8_t Command_AutoRepeatMode = '~';
     static const uint8_t Command_NoAutoRepeatMode = '`';
@@ -170,15 +324,53 @@ class LK204_25_Keypad : public IKeypad, private LK204_25_Base {
     static const uint8_t Command_ClearBuffer = 'E';
     static const uint8_t Command_ReadKey = '&';
     static const uint8_t Command_SetDebounce = 'U';
+    static const uint8_t ModuleBuffer = 10; // keys the module holds
+    static const uint8_t MoreKeys = 0x80;
+    KeyQueue<16> _queue;
+    unsigned int _pollMs;
+    unsigned long _lastPoll;
+    unsigned long _busReads;
 
 public:
-    LK204_25_Keypad(uint8_t keypad_addr = DefaultAddress) : LK204_25_Base(keypad_addr) { }
+    LK204_25_Keypad(uint8_t keypad_addr = DefaultAddress, unsigned int pollMs = 20) : LK204_25_Device(keypad_addr),
+        _pollMs(pollMs), _lastPoll(0), _busReads(0) { }
     void begin() { Wire.begin(); }
-    void clear() { send_command(Command_ClearBuffer); }
+    void clear() {
+        send_command(Command_ClearBuffer);
+        _queue.clear();
+    }
     uint8_t read() {
+        if (_queue.empty()) {
+            unsigned long now = millis();
+            if (!_pollMs || _busReads == 0 || now - _lastPoll >= _pollMs) {
+                _lastPoll = now;
+                fetch();
+            }
+        }
+        return _queue.pop();
+    }
+    // I2C reads so far, for comparing poll rates.
+    unsigned long busReads() const { return _busReads; }
+    using LK204_25_Device::errors;
+
+private:
+    void fetch() {
         const uint8_t quantity = 1;
-        // send_command(Command_ReadKey);
-        Wire.requestFrom(getAddr(), quantity);
-        return Wire.read();
+        for (uint8_t i = 0; i < ModuleBuffer; i++) {
+            // send_command(Command_ReadKey);
+            _busReads++;
+            if (Wire.requestFrom(getAddr(), quantity) != quantity) {
+                return;
+            }
+            int key = Wire.read();
+            // Nothing there, or a bus that floated high.
+            if (key <= 0 || key == 0xFF) {
+                return;
+            }
+            _queue.push(key & ~MoreKeys);
+            if (!(key & MoreKeys)) {
+                return;
+            }
+        }
     }
 };
@@ -0,0 +1,165 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Scheduler.hpp>
+#include <ILCD.h>
+
+/*
+MatrixKeypad scans a key matrix wired straight to GPIO pins.  It's an
+IKeypad, so it plugs into KeypadHandler in place of LK204_25_Keypad.
+
+Each poll() reads the columns for one row and then selects the next row, so
+the lines have a whole loop to settle and a poll costs the same few pin
+operations however big the matrix is.  Rows are driven LOW one at a time
+and left floating otherwise; columns use INPUT_PULLUP.
+
+Debouncing is done for a whole row at once with a vertical counter: a key
+changes state only after reading the same level on four scans of its row in
+a row.  Any number of keys may be down together (n-key rollover); presses
+are queued in the order they're recognised and read() hands them out.  With
+reportReleases, releases are queued too, as the key code with Released set.
+Without a diode per key, three keys at the corners of a rectangle make the
+fourth look pressed.
+
+Up to 16 columns.
+
+keys is what read() returns for each key.  The handlers in this library
+(MenuKeypadController, KeyDispatchTable, the games) compare against the
+KeypadKey_* codes in KeypadHandler.hpp, which are what the LK204-25 sends,
+not the characters printed on the keys.  For the usual 4x4 membrane keypad
+
+  1 2 3 A
+  4 5 6 B
+  7 8 9 C
+  * 0 # D
+
+use MatrixKeypad_Keys4x4, which maps it to those codes.
+
+const uint8_t rowPins[4] = { 2, 3, 4, 5 };
+const uint8_t colPins[4] = { 6, 7, 8, 9 };
+MainSchedule schedule;
+MatrixKeypad<4, 4> keypad(schedule, rowPins, colPins, MatrixKeypad_Keys4x4);
+KeypadHandler keypadHandler(schedule, keypad, keyHandler);
+void setup() { keypad.begin(); schedule.begin(); }
+void loop() { schedule.poll(); }
+*/
+
+// KeypadKey_1, _2, _3, _A, _4 ... _Asterisk, _0, _Pound, _D, row by row.
+const char MatrixKeypad_Keys4x4[] = "ABCDFGHIKLMNPQRS";
+
+template <int TRows, int TCols>
+class MatrixKeypad : public IKeypad, private Scheduled {
+	typedef uint16_t Bits;
+	const uint8_t *_rowPins;
+	const uint8_t *_colPins;
+	const char *_keys;
+	bool _reportReleases;
+	uint8_t _row;       // row selected by the last poll
+	Bits _state[TRows]; // debounced, 1 = down
+	Bits _count0[TRows];
+	Bits _count1[TRows];
+	KeyQueue<16> _queue;
+public:
+	static const uint8_t Released = 0x80;
+
+	// keys holds TRows * TCols key codes (KeypadKey_*), row by row.
+	MatrixKeypad(Schedule &schedule, const uint8_t *rowPins, const uint8_t *colPins, const char *keys, bool reportReleases = false) :
+		Scheduled(schedule), _rowPins(rowPins), _colPins(colPins), _keys(keys), _reportReleases(reportReleases), _row(0) {
+		for (int r = 0; r < TRows; r++) {
+			_state[r] = 0;
+			_count0[r] = 0;
+			_count1[r] = 0;
+		}
+	}
+	void begin() {
+		for (int c = 0; c < TCols; c++) {
+			pinMode(_colPins[c], INPUT_PULLUP);
+		}
+		for (int r = 0; r < TRows; r++) {
+			pinMode(_rowPins[r], INPUT);
+		}
+		select(_row);
+	}
+	uint8_t read() { return _queue.pop(); }
+	void clear() { _queue.clear(); }
+
+	void poll() {
+		Bits sample = 0;
+		for (int c = 0; c < TCols; c++) {
+			if (!digitalRead(_colPins[c])) {
+				sample |= (Bits)1 << c;
+			}
+		}
+		// Two-bit counter per key, reset whenever the sample agrees with the state.
+		Bits delta = sample ^ _state[_row];
+		_count1[_row] = (_count1[_row] ^ _count0[_row]) & delta;
+		_count0[_row] = ~_count0[_row] & delta;
+		Bits toggled = delta & ~(_count0[_row] | _count1[_row]);
+		if (toggled) {
+			_state[_row] ^= toggled;
+			queue(_row, toggled);
+		}
+		pinMode(_rowPins[_row], INPUT);
+		_row = _row + 1 < TRows ? _row + 1 : 0;
+		select(_row);
+	}
+
+	bool down(int row, int col) const { return (_state[row] >> col) & 1; }
+	bool down(char key) const {
+		for (int i = 0; i < TRows * TCols; i++) {
+			if (_keys[i] == key) return down(i / TCols, i % TCols);
+		}
+		return false;
+	}
+	// Keys currently held.
+	int downCount() const {
+		int n = 0;
+		for (int r = 0; r < TRows; r++) {
+			for (Bits b = _state[r]; b; b &= b - 1) n++;
+		}
+		return n;
+	}
+	// Events lost because read() wasn't keeping up.
+	uint8_t dropped() const { return _queue.dropped(); }
+
+private:
+	void select(uint8_t row) {
+		pinMode(_rowPins[row], OUTPUT);
+		digitalWrite(_rowPins[row], LOW);
+	}
+	void queue(uint8_t row, Bits toggled) {
+		for (int c = 0; c < TCols; c++) {
+			if (!((toggled >> c) & 1)) continue;
+			char key = _keys[row * TCols + c];
+			if ((_state[row] >> c) & 1) {
+				_queue.push(key);
+			} else if (_reportReleases) {
+				_queue.push(key | Released);
+			}
+		}
+	}
+};
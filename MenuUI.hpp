@@ -28,7 +28,6 @@ SOFTWARE.
 #include <Display.hpp>
 #include <KeypadHandler.hpp>
 #include <string.h>
-#include <stdio.h>
 #include <limits.h>
 
 // A small retained-mode menu system designed for character LCDs.
@@ -44,7 +43,27 @@ enum MenuItemKind {
 };
 
 class MenuContext;
+class MenuScreenBase;
+
+// Letters on a phone-style keypad key, digit first; 0 if the key has none.
+inline const char *menuKeypadLetters(char key) {
+	switch (key) {
+		case KeypadKey_0: return "0";
+		case KeypadKey_1: return "1";
+		case KeypadKey_2: return "2abcABC";
+		case KeypadKey_3: return "3defDEF";
+		case KeypadKey_4: return "4ghiGHI";
+		case KeypadKey_5: return "5jklJKL";
+		case KeypadKey_6: return "6mnoMNO";
+		case KeypadKey_7: return "7pqrsPQRS";
+		case KeypadKey_8: return "8tuvTUV";
+		case KeypadKey_9: return "9wxyzWXYZ";
+		default: return 0;
+	}
+}
 
+// For items from a FlashMenuScreen, label points into flash; read it through
+// MenuScreenBase::copyLabel().
 struct MenuItem {
 	const char *label;
 	MenuItemKind kind;
@@ -67,12 +86,12 @@ struct MenuItem {
 		i.longDelayMs = 1500;
 		return i;
 	}
-	static MenuItem Submenu(const char *labelValue, void *menu) {
+	static MenuItem Submenu(const char *labelValue, const MenuScreenBase *menu) {
 		MenuItem i;
 		i.label = labelValue;
 		i.kind = MenuItem_Submenu;
 		i.action = 0;
-		i.target = menu;
+		i.target = (void *)menu;
 		i.step = 1;
 		i.maxLen = 0;
 		i.shortDelayMs = 750;
@@ -129,21 +148,108 @@ struct MenuItem {
 	}
 };
 
-class MenuScreen {
+// What MenuContext and MenuRenderer need from a screen.  Text is copied out
+// rather than pointed to, so it can come from RAM, flash or a callback.
+class MenuScreenBase {
+public:
+	virtual int count() const = 0;
+	virtual MenuItem item(int index) const = 0;
+	// Copy the title, or an item's label, into out, truncated and NUL-terminated.
+	virtual void copyTitle(char *out, int size) const = 0;
+	virtual void copyLabel(int index, char *out, int size) const = 0;
+	// Keys the controller didn't use are offered here; return true if handled.
+	virtual bool handleKey(MenuContext &ctx, char ch) const { (void)ctx; (void)ch; return false; }
+
+	static void copyText(char *out, int size, const char *text, bool progmem = false) {
+		if (size <= 0) return;
+		int n = 0;
+		if (text) {
+			for (; n < size - 1; n++) {
+				char ch = progmem ? (char)pgm_read_byte(text + n) : text[n];
+				if (!ch) break;
+				out[n] = ch;
+			}
+		}
+		out[n] = 0;
+	}
+};
+
+class MenuScreen : public MenuScreenBase {
 	const char *_title;
 	const MenuItem *_items;
 	int _count;
 public:
 	MenuScreen(const char *title, const MenuItem *items, int count) : _title(title), _items(items), _count(count) { }
 	const char *title() const { return _title; }
-	const MenuItem &item(int index) const { return _items[index]; }
+	MenuItem item(int index) const { return _items[index]; }
+	int count() const { return _count; }
+	void copyTitle(char *out, int size) const { copyText(out, size, _title); }
+	void copyLabel(int index, char *out, int size) const { copyText(out, size, _items[index].label); }
+};
+
+/*
+Menus kept entirely in flash.  Each item is 9 bytes of flash on AVR and no
+RAM; a FlashMenuScreen costs a few bytes of RAM however many items it has.
+Labels and titles are PROGMEM strings.  EnterString items use the default
+750/1500ms multi-tap delays.
+
+static void menuBack(MenuContext &ctx) { ctx.pop(); }
+const char lblUpTime[] PROGMEM = "Set up-time";
+const char lblBack[] PROGMEM = "Back";
+const char lblTiming[] PROGMEM = "Timing";
+const FlashMenuItem timingItems[] PROGMEM = {
+	MENU_EDIT_LONG_P(lblUpTime, upTime, 25),
+	MENU_ACTION_P(lblBack, menuBack)
+};
+FlashMenuScreen timingMenu(lblTiming, timingItems, 2);
+*/
+struct FlashMenuItem {
+	const char *label;
+	uint8_t kind;
+	int16_t param;  // EditLong step, EnterString length
+	void (*action)(MenuContext &ctx);
+	void *target;
+};
+
+#define MENU_ACTION_P(label, fn) { (label), MenuItem_Action, 1, &(fn), 0 }
+#define MENU_SUBMENU_P(label, menu) { (label), MenuItem_Submenu, 1, 0, (void *)static_cast<const MenuScreenBase *>(&(menu)) }
+#define MENU_TOGGLE_P(label, enabled) { (label), MenuItem_ToggleEnabled, 1, 0, (void *)static_cast<Enabled *>(&(enabled)) }
+#define MENU_EDIT_LONG_P(label, value, step) { (label), MenuItem_EditLong, (step), 0, (void *)&(value) }
+#define MENU_ENTER_LONG_P(label, value) { (label), MenuItem_EnterLong, 1, 0, (void *)&(value) }
+#define MENU_ENTER_STRING_P(label, value, maxLen) { (label), MenuItem_EnterString, (maxLen), 0, (void *)(value) }
+
+class FlashMenuScreen : public MenuScreenBase {
+	const char *_title;
+	const FlashMenuItem *_items;
+	uint8_t _count;
+public:
+	FlashMenuScreen(const char *title, const FlashMenuItem *items, uint8_t count) : _title(title), _items(items), _count(count) { }
 	int count() const { return _count; }
+	MenuItem item(int index) const {
+		FlashMenuItem packed;
+		memcpy_P(&packed, &_items[index], sizeof(packed));
+		MenuItem i;
+		i.label = packed.label;
+		i.kind = (MenuItemKind)packed.kind;
+		i.action = packed.action;
+		i.target = packed.target;
+		i.step = packed.kind == MenuItem_EditLong ? packed.param : 1;
+		i.maxLen = packed.kind == MenuItem_EnterString ? packed.param : 0;
+		i.shortDelayMs = 750;
+		i.longDelayMs = 1500;
+		return i;
+	}
+	void copyTitle(char *out, int size) const { copyText(out, size, _title, true); }
+	void copyLabel(int index, char *out, int size) const {
+		copyText(out, size, (const char *)pgm_read_ptr(&_items[index].label), true);
+	}
 };
 
 class MenuContext {
 	static const int MaxEditString = 32;
 	static const int MaxStack = 8;
-	const MenuScreen *_stack[MaxStack];
+	static const int MaxEditLabel = 21;
+	const MenuScreenBase *_stack[MaxStack];
 	int _depth;
 	int _selected;
 	int _top;
@@ -153,7 +259,7 @@ class MenuContext {
 	bool _editing;
 	long *_editValue;
 	long _editStep;
-	const char *_editLabel;
+	char _editLabel[MaxEditLabel];
 	MenuItemKind _editKind;
 	long _editOriginal;
 	long _enterValue;
@@ -167,23 +273,37 @@ class MenuContext {
 	unsigned long _stringLastPress;
 	long _stringShortDelay;
 	long _stringLongDelay;
+
+	// Bumped whenever what the renderer shows might have changed.  Content
+	// is bumped only when item text may have changed, so rows that merely
+	// moved or were reselected needn't be formatted again.
+	unsigned int _revision;
+	unsigned int _content;
+	void bump() { _revision++; }
 public:
-	MenuContext(const MenuScreen &root, int visibleRows = 3) : _depth(0), _selected(0), _top(0), _visibleRows(visibleRows), _editing(false), _editValue(0), _editStep(1), _editLabel(0), _editKind(MenuItem_Action), _editOriginal(0), _enterValue(0), _enterStarted(false), _editString(0), _editStringMax(0), _editStringPos(0), _stringPendingKey(0), _stringPendingIndex(0), _stringLastPress(0), _stringShortDelay(750), _stringLongDelay(1500) {
+	MenuContext(const MenuScreenBase &root, int visibleRows = 3) : _depth(0), _selected(0), _top(0), _visibleRows(visibleRows), _editing(false), _editValue(0), _editStep(1), _editKind(MenuItem_Action), _editOriginal(0), _enterValue(0), _enterStarted(false), _editString(0), _editStringMax(0), _editStringPos(0), _stringPendingKey(0), _stringPendingIndex(0), _stringLastPress(0), _stringShortDelay(750), _stringLongDelay(1500), _revision(0), _content(0) {
 		_stack[0] = &root;
+		_editLabel[0] = 0;
 		_editStringOriginal[0] = 0;
 	}
 
-	const MenuScreen &screen() const { return *_stack[_depth]; }
+	const MenuScreenBase &screen() const { return *_stack[_depth]; }
 	int selected() const { return _selected; }
 	int top() const { return _top; }
 	bool editing() const { return _editing; }
+	unsigned int revision() const { return _revision; }
+	unsigned int contentRevision() const { return _content; }
+	// Call after changing text a menu title or label points at, from
+	// anywhere but a menu action (actions are assumed to change things).
+	void touch() { _revision++; _content++; }
 
-	void push(const MenuScreen &screen) {
+	void push(const MenuScreenBase &screen) {
 		if (_depth + 1 < MaxStack) {
 			_depth++;
 			_stack[_depth] = &screen;
 			_selected = 0;
 			_top = 0;
+			bump();
 		}
 	}
 	void pop() {
@@ -197,7 +317,7 @@ public:
 			}
 			_editing = false;
 			_editValue = 0;
-			_editLabel = 0;
+			_editLabel[0] = 0;
 			_editKind = MenuItem_Action;
 			_enterStarted = false;
 			_editString = 0;
@@ -206,32 +326,41 @@ public:
 			_stringPendingKey = 0;
 			_stringPendingIndex = 0;
 			_stringLastPress = 0;
+			bump();
 			return;
 		}
 		if (_depth > 0) {
 			_depth--;
 			_selected = 0;
 			_top = 0;
+			bump();
 		}
 	}
 
 	void move(int delta) {
 		if (_editing) {
-			if (_editKind == MenuItem_EditLong && _editValue) {
+			if (_editKind == MenuItem_EditLong && _editValue && delta) {
 				*_editValue += (long)delta * _editStep;
+				bump();
 			}
 			return;
 		}
 		int c = screen().count();
 		if (c <= 0) return;
-		_selected += delta;
-		if (_selected < 0) _selected = 0;
-		if (_selected >= c) _selected = c - 1;
+		int selected = _selected + delta;
+		if (selected < 0) selected = 0;
+		if (selected >= c) selected = c - 1;
 		// Keep selected visible; title consumes row 0.
 		const int visible = _visibleRows;
-		if (_selected < _top) _top = _selected;
-		if (_selected >= _top + visible) _top = _selected - visible + 1;
-		if (_top < 0) _top = 0;
+		int top = _top;
+		if (selected < top) top = selected;
+		if (selected >= top + visible) top = selected - visible + 1;
+		if (top < 0) top = 0;
+		if (selected != _selected || top != _top) {
+			_selected = selected;
+			_top = top;
+			bump();
+		}
 	}
 
 	void activate() {
@@ -242,7 +371,7 @@ public:
 			}
 			_editing = false;
 			_editValue = 0;
-			_editLabel = 0;
+			_editLabel[0] = 0;
 			_editKind = MenuItem_Action;
 			_enterStarted = false;
 			_editString = 0;
@@ -251,15 +380,19 @@ public:
 			_stringPendingKey = 0;
 			_stringPendingIndex = 0;
 			_stringLastPress = 0;
+			bump();
 			return;
 		}
-		const MenuItem &it = screen().item(_selected);
+		if (_selected >= screen().count()) return;
+		const MenuItem it = screen().item(_selected);
+		bump();
 		switch (it.kind) {
 			case MenuItem_Action:
 				if (it.action) it.action(*this);
+				touch();
 				break;
 			case MenuItem_Submenu:
-				if (it.target) push(*(const MenuScreen*)it.target);
+				if (it.target) push(*(const MenuScreenBase*)it.target);
 				break;
 			case MenuItem_ToggleEnabled:
 				if (it.target) ((Enabled*)it.target)->toggle();
@@ -268,7 +401,7 @@ public:
 				_editing = true;
 				_editValue = (long*)it.target;
 				_editStep = it.step;
-				_editLabel = it.label;
+				screen().copyLabel(_selected, _editLabel, sizeof(_editLabel));
 				_editKind = MenuItem_EditLong;
 				_editOriginal = _editValue ? *_editValue : 0;
 				break;
@@ -276,7 +409,7 @@ public:
 				_editing = true;
 				_editValue = (long*)it.target;
 				_editStep = 1;
-				_editLabel = it.label;
+				screen().copyLabel(_selected, _editLabel, sizeof(_editLabel));
 				_editKind = MenuItem_EnterLong;
 				_editOriginal = _editValue ? *_editValue : 0;
 				if (_editOriginal < 0) _editOriginal = 0;
@@ -287,7 +420,7 @@ public:
 				_editing = true;
 				_editValue = 0;
 				_editStep = 1;
-				_editLabel = it.label;
+				screen().copyLabel(_selected, _editLabel, sizeof(_editLabel));
 				_editKind = MenuItem_EnterString;
 				_editString = (char*)it.target;
 				_editStringMax = it.maxLen;
@@ -345,10 +478,17 @@ public:
 			_stringPendingKey = 0;
 			_stringPendingIndex = 0;
 			_stringLastPress = 0;
+			bump();
 		}
 	}
 	bool handleEditKey(char ch) {
 		if (!_editing) return false;
+		if (!editKey(ch)) return false;
+		bump();
+		return true;
+	}
+private:
+	bool editKey(char ch) {
 		if (_editKind == MenuItem_EnterLong) {
 			if (ch == KeypadKey_Pound || ch == KeypadKey_Hash || ch == KeypadKey_Octothorpe) {
 				activate();
@@ -409,20 +549,7 @@ public:
 			}
 
 			char key = ch;
-			const char *opts = 0;
-			switch (key) {
-				case KeypadKey_0: opts = "0"; break;
-				case KeypadKey_1: opts = "1"; break;
-				case KeypadKey_2: opts = "2abcABC"; break;
-				case KeypadKey_3: opts = "3defDEF"; break;
-				case KeypadKey_4: opts = "4ghiGHI"; break;
-				case KeypadKey_5: opts = "5jklJKL"; break;
-				case KeypadKey_6: opts = "6mnoNBO"; break;
-				case KeypadKey_7: opts = "7pqrsPQRS"; break;
-				case KeypadKey_8: opts = "8tuvTUV"; break;
-				case KeypadKey_9: opts = "9wxyzWXYZ"; break;
-				default: opts = 0; break;
-			}
+			const char *opts = menuKeypadLetters(key);
 			if (!opts) return false;
 
 			unsigned long now = millis();
@@ -471,6 +598,93 @@ public:
 	}
 };
 
+/*
+A menu over a list that is never held in memory: the item count and labels
+come from callbacks, asked only for the rows on screen, so memory use doesn't
+depend on the length of the list.  Selecting any item calls one action, which
+reads ctx.selected() to see which.  The count is asked for again on every
+use, so the list may change underneath.  MenuRenderer keeps the labels on
+screen and notices a new count by itself, but if labels change while the
+count stays the same (a rescan that finds different files), call
+ctx.touch() afterwards so they're asked for again.
+
+static int fileCount() { return storyCount; }
+static void fileLabel(int index, char *out, int size) { storyName(index, out, size); }
+static void fileOpen(MenuContext &ctx) { openStory(ctx.selected()); ctx.pop(); }
+VirtualMenuScreen filesMenu("Stories", fileCount, fileLabel, fileOpen);
+void rescan() { scanStories(); menuContext.touch(); }
+
+Keypad keys that MenuKeypadController doesn't map are used for type-ahead:
+each key narrows a prefix and the selection jumps to the first label that
+starts with it.  A digit key matches any of its letters, phone style (4
+matches g, h, i or 4).  typeAhead() does the same for plain text, say from
+Serial, ignoring case.  The prefix starts over after typeAheadMs without a
+key.  Each key costs one pass over the labels.
+*/
+class VirtualMenuScreen : public MenuScreenBase {
+	static const int MaxTypeAhead = 8;
+	const char *_title;
+	int (*_count)();
+	void (*_label)(int index, char *out, int size);
+	void (*_action)(MenuContext &ctx);
+	long _typeAheadMs;
+	mutable char _typed[MaxTypeAhead];
+	mutable uint8_t _typedCount;
+	mutable bool _typedKeypad;
+	mutable unsigned long _lastKey;
+
+	static char lower(char ch) { return ch >= 'A' && ch <= 'Z' ? ch - 'A' + 'a' : ch; }
+	bool matches(char typed, char ch) const {
+		if (_typedKeypad) return ch && strchr(menuKeypadLetters(typed), ch) != 0;
+		return lower(typed) == lower(ch);
+	}
+	bool startsWithTyped(int index) const {
+		char label[MaxTypeAhead + 1];
+		copyLabel(index, label, _typedCount + 1);
+		for (uint8_t i = 0; i < _typedCount; i++) {
+			if (!matches(_typed[i], label[i])) return false;
+		}
+		return true;
+	}
+	bool jump(MenuContext &ctx, char ch, bool keypad) const {
+		if (_typeAheadMs <= 0 || !_label || ctx.editing()) return false;
+		unsigned long now = millis();
+		if (_typedCount && ((long)(now - _lastKey) > _typeAheadMs || keypad != _typedKeypad)) _typedCount = 0;
+		_lastKey = now;
+		_typedKeypad = keypad;
+		if (_typedCount < MaxTypeAhead) _typed[_typedCount++] = ch;
+		int c = count();
+		for (int i = 0; i < c; i++) {
+			if (startsWithTyped(i)) {
+				ctx.move(i - ctx.selected());
+				break;
+			}
+		}
+		return true;
+	}
+public:
+	VirtualMenuScreen(const char *title, int (*count)(), void (*label)(int index, char *out, int size), void (*action)(MenuContext &ctx), long typeAheadMs = 1000) :
+		_title(title), _count(count), _label(label), _action(action), _typeAheadMs(typeAheadMs), _typedCount(0), _typedKeypad(false), _lastKey(0) { }
+	int count() const { return _count ? _count() : 0; }
+	MenuItem item(int index) const { (void)index; return MenuItem::Action(0, _action); }
+	void copyTitle(char *out, int size) const { copyText(out, size, _title); }
+	void copyLabel(int index, char *out, int size) const {
+		if (size <= 0) return;
+		out[0] = 0;
+		if (_label) _label(index, out, size);
+		out[size - 1] = 0;
+	}
+	bool handleKey(MenuContext &ctx, char ch) const {
+		return menuKeypadLetters(ch) ? jump(ctx, ch, true) : false;
+	}
+	bool typeAhead(MenuContext &ctx, char ch) const {
+		return ch >= ' ' && ch <= '~' ? jump(ctx, ch, false) : false;
+	}
+	// Forget the prefix typed so far.
+	void clearTypeAhead() const { _typedCount = 0; }
+	int typedLength() const { return _typedCount; }
+};
+
 struct MenuKeymap {
 	char up;
 	char down;
@@ -499,17 +713,53 @@ public:
 		if (ch == _keys.line2) { _ctx.selectVisibleRow(1); return true; }
 		if (ch == _keys.line3) { _ctx.selectVisibleRow(2); return true; }
 		if (ch == _keys.line4) { _ctx.selectVisibleRow(3); return true; }
-		return false;
+		return _ctx.screen().handleKey(_ctx, ch);
 	}
 };
 
 // Rendering: writes menu text into the buffer. This is the object you pass to MainDisplay.
+//
+// changed() is false until the MenuContext revision moves, a visible toggle
+// flips, the item count changes or the value being edited changes, so an idle
+// menu costs MainDisplay nothing.  The title and labels of the visible rows
+// are kept and only copied out again for rows showing a different item, when
+// the item count changes, or after the content changed (an action ran, or
+// MenuContext::touch()).
 template <class TDisplay, int TRows = 4, int TCols = 20>
 class MenuRenderer : public DisplayDrawable<TDisplay, TRows, TCols> {
+	// Row 0 is the title; the rest are the visible items.
+	struct Row {
+		const MenuScreenBase *screen;
+		int index;
+		unsigned int content;
+		Enabled *toggle;
+		bool on;
+		char text[TCols + 1];
+	};
 	MenuContext &_ctx;
 	char _selChar;
+	Row _rows[TRows];
+	bool _drawn;
+	unsigned int _drawnRevision;
+	int _drawnCount;
+	long _drawnValue;
 public:
-	MenuRenderer(MenuContext &ctx, char selectionChar = '>') : _ctx(ctx), _selChar(selectionChar) { }
+	MenuRenderer(MenuContext &ctx, char selectionChar = '>') : _ctx(ctx), _selChar(selectionChar), _drawn(false), _drawnRevision(0), _drawnCount(0), _drawnValue(0) {
+		for (int r = 0; r < TRows; r++) {
+			_rows[r].screen = 0;
+			_rows[r].toggle = 0;
+		}
+	}
+	bool changed() override {
+		_ctx.tick();
+		if (!_drawn || _ctx.revision() != _drawnRevision) return true;
+		if (_ctx.editing()) return _ctx.editValue() != _drawnValue;
+		if (_ctx.screen().count() != _drawnCount) return true;
+		for (int r = 1; r < TRows; r++) {
+			if (_rows[r].toggle && _rows[r].toggle->enabled() != _rows[r].on) return true;
+		}
+		return false;
+	}
 	bool wantsCursor() override {
 		if (!_ctx.editing()) return false;
 		MenuItemKind k = _ctx.editKind();
@@ -530,9 +780,7 @@ public:
 		if (k == MenuItem_EnterLong) {
 			row = 1;
 			char temp[32];
-			temp[0] = 0;
-			snprintf(temp, sizeof(temp), "Enter:%ld", _ctx.editValue());
-			col = (int)strlen(temp);
+			col = TextBuilder(temp).text("Enter:").number(_ctx.editValue()).length();
 			if (col < 0) col = 0;
 			if (col >= TCols) col = TCols - 1;
 			return;
@@ -540,69 +788,87 @@ public:
 	}
 	void draw(DisplayBuffer<TRows, TCols> &buffer) {
 		_ctx.tick();
+		_drawn = true;
+		_drawnRevision = _ctx.revision();
 		buffer.clear(' ');
 
-		// Header line
-		const char *title = _ctx.editing() ? _ctx.editLabel() : _ctx.screen().title();
-		if (title) {
-			buffer.write(0, 0, title, TCols);
+		if (_ctx.editing()) {
+			drawEdit(buffer);
+			return;
 		}
 
-		if (_ctx.editing()) {
-			char line[TCols + 1];
-			line[0] = 0;
-			if (_ctx.editKind() == MenuItem_EnterLong) {
-				snprintf(line, sizeof(line), "Enter:%ld", _ctx.editValue());
-				buffer.write(1, 0, line, TCols);
-				if (TRows >= 4) buffer.write(TRows - 2, 0, "0-9 type *=Del", TCols);
-				if (TRows >= 3) buffer.write(TRows - 1, 0, "#=OK Back=Cancel", TCols);
-				return;
-			}
-			if (_ctx.editKind() == MenuItem_EnterString) {
-				buffer.write(1, 0, _ctx.editString(), TCols);
-				if (TRows >= 4) buffer.write(TRows - 2, 0, "0-9 type *=Del", TCols);
-				if (TRows >= 3) buffer.write(TRows - 1, 0, "#=OK Back=Cancel", TCols);
-				return;
+		const MenuScreenBase &screen = _ctx.screen();
+		const unsigned int content = _ctx.contentRevision();
+		const int count = screen.count();
+		if (count != _drawnCount) {
+			// Items were added or removed, so the rest may have moved.
+			for (int r = 1; r < TRows; r++) {
+				_rows[r].screen = 0;
 			}
-			snprintf(line, sizeof(line), "Value:%ld", _ctx.editValue());
-			buffer.write(1, 0, line, TCols);
-			if (TRows >= 4) buffer.write(TRows - 2, 0, "Up/Down change", TCols);
-			if (TRows >= 3) buffer.write(TRows - 1, 0, "Select=OK Back=Esc", TCols);
-			return;
 		}
+		_drawnCount = count;
+		Row &title = _rows[0];
+		if (title.screen != &screen || title.content != content) {
+			title.screen = &screen;
+			title.content = content;
+			screen.copyTitle(title.text, sizeof(title.text));
+		}
+		buffer.write(0, 0, title.text, TCols);
 
 		// Menu lines: row 0 is header.
-		int visible = TRows - 1;
-		if (visible <= 0) return;
-		for (int i = 0; i < visible; i++) {
-			int idx = _ctx.top() + i;
-			int row = 1 + i;
-			if (idx >= _ctx.screen().count()) break;
-
-			const MenuItem &it = _ctx.screen().item(idx);
-			char line[TCols + 1];
-			for (int k = 0; k < TCols; k++) line[k] = ' ';
-			line[TCols] = 0;
-
-			// Selection marker
-			line[0] = (idx == _ctx.selected()) ? _selChar : ' ';
-			int cursor = 1;
-
-			// Optional indicator for toggles
-			if (it.kind == MenuItem_ToggleEnabled && it.target) {
-				bool on = ((Enabled*)it.target)->enabled();
-				line[1] = on ? '*' : ' ';
-				cursor = 2;
+		for (int row = 1; row < TRows; row++) {
+			Row &r = _rows[row];
+			int idx = _ctx.top() + row - 1;
+			if (idx >= _drawnCount) {
+				r.screen = 0;
+				r.toggle = 0;
+				continue;
+			}
+			if (r.screen != &screen || r.index != idx || r.content != content) {
+				r.screen = &screen;
+				r.index = idx;
+				r.content = content;
+				const MenuItem it = screen.item(idx);
+				r.toggle = it.kind == MenuItem_ToggleEnabled ? (Enabled*)it.target : 0;
+				screen.copyLabel(idx, r.text, sizeof(r.text));
 			}
 
-			// Label
-			if (it.label) {
-				int n = (int)strlen(it.label);
-				for (int j = 0; j < n && cursor + j < TCols; j++) {
-					line[cursor + j] = it.label[j];
-				}
+			// Selection marker, then the indicator for toggles, then the label.
+			buffer.set(row, 0, idx == _ctx.selected() ? _selChar : ' ');
+			int cursor = 1;
+			if (r.toggle) {
+				r.on = r.toggle->enabled();
+				buffer.set(row, 1, r.on ? '*' : ' ');
+				cursor = 2;
 			}
-			buffer.write(row, 0, line, TCols);
+			buffer.write(row, cursor, r.text, TCols - cursor);
+		}
+	}
+private:
+	void drawEdit(DisplayBuffer<TRows, TCols> &buffer) {
+		for (int r = 1; r < TRows; r++) {
+			_rows[r].toggle = 0;
+		}
+		_drawnValue = _ctx.editValue();
+		buffer.write(0, 0, _ctx.editLabel(), TCols);
+		char line[TCols + 1];
+		line[0] = 0;
+		if (_ctx.editKind() == MenuItem_EnterLong) {
+			TextBuilder(line).text("Enter:").number(_drawnValue);
+			buffer.write(1, 0, line, TCols);
+			if (TRows >= 4) buffer.write(TRows - 2, 0, "0-9 type *=Del", TCols);
+			if (TRows >= 3) buffer.write(TRows - 1, 0, "#=OK Back=Cancel", TCols);
+			return;
+		}
+		if (_ctx.editKind() == MenuItem_EnterString) {
+			buffer.write(1, 0, _ctx.editString(), TCols);
+			if (TRows >= 4) buffer.write(TRows - 2, 0, "0-9 type *=Del", TCols);
+			if (TRows >= 3) buffer.write(TRows - 1, 0, "#=OK Back=Cancel", TCols);
+			return;
 		}
+		TextBuilder(line).text("Value:").number(_drawnValue);
+		buffer.write(1, 0, line, TCols);
+		if (TRows >= 4) buffer.write(TRows - 2, 0, "Up/Down change", TCols);
+		if (TRows >= 3) buffer.write(TRows - 1, 0, "Select=OK Back=Esc", TCols);
 	}
 };
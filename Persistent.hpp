@@ -46,29 +46,284 @@ Use PersistentValue<T>::Size to compute the next address:
 
 On first flash EEPROM contains uninitialized bytes — call reset(defaultValue)
 to write a known-good starting value.
+
+For values that change often, give them an EEPROMLog instead of an address;
+see below.
 */
 
+#ifndef EEPROM_LOG_IDS
+#define EEPROM_LOG_IDS 16 // values one EEPROMLog can hold, ids 0 .. EEPROM_LOG_IDS-1
+#endif
+
+/*
+EEPROMLog spreads writes over a whole region of EEPROM instead of wearing
+the same cells on every save.  Each save appends one record holding just
+that value:
+
+    id (1)  sequence (4, little-endian)  value (valueSize)  CRC-8 (1)
+
+to the next slot that doesn't hold the current record of some value.  The
+old record stays where it was until the new one is complete, so a reset in
+the middle of a save loses only that save.  Slots holding superseded
+records are reused in turn, which is all the compaction a log of fixed-size
+slots needs; slots holding current records are skipped until they're
+superseded.  At startup the region is scanned and, for each id, the record
+with the highest sequence number and a good CRC wins.  Bytes that already
+hold the right value aren't rewritten.
+
+The CRC starts from 0xFF and sequence numbers from 1, so neither erased
+(0xFF) nor zeroed cells read as a record.
+
+With N slots and k values, each slot is written about once every N - k
+saves, so the region lasts roughly (N - k) times longer than a fixed
+address.  There must be more slots than values.
+
+  EEPROMLog settings(0, 256);                      // bytes 0..255, 4-byte values
+  PersistentValue<long> savedSpeed(schedule, settings, 0, speed);
+  PersistentValue<int>  savedMode (schedule, settings, 1, mode);
+
+The region is scanned the first time it's used once EEPROM covers it.  On
+ESP32 and ESP8266, EEPROM reads as empty until EEPROM.begin(size) in
+setup(), so call that first; until then the log reads nothing and refuses
+to write, and a PersistentValue built as a global loads its value on its
+first poll() instead of in its constructor.  begin() scans again, for
+after EEPROM has been changed behind the log's back.
+
+  void setup() {
+    EEPROM.begin(512);   // ESP32/ESP8266 only
+    schedule.begin();
+  }
+
+A value with no record yet keeps whatever it held before loading, so a
+fresh region starts from the defaults in the sketch.  A value bigger than
+valueSize can't be stored, and a save fails if every slot holds a current
+record; save() returns false and errors() counts both.
+*/
+class EEPROMLog {
+    static const uint8_t Erased = 0xFF;
+    static const uint8_t HeaderSize = 5; // id + sequence
+    static const uint8_t CrcStart = 0xFF;
+    int _start;
+    int _slots;
+    uint8_t _valueSize;
+    bool _scanned;
+    int _current[EEPROM_LOG_IDS];  // slot of each id's current record, -1 if none
+    uint32_t _sequence;             // of the newest record
+    int _next;                      // where the search for a free slot starts
+public:
+    EEPROMLog(int start, int size, uint8_t valueSize = 4) :
+        _start(start), _slots(size / (HeaderSize + valueSize + 1)), _valueSize(valueSize),
+        _scanned(false), _sequence(0), _next(0) { }
+
+    int slotSize() const { return HeaderSize + _valueSize + 1; }
+    int slots() const { return _slots; }
+    uint8_t valueSize() const { return _valueSize; }
+    uint32_t sequence() { scan(); return _sequence; }
+
+    // Scans the region again; false if EEPROM doesn't cover it yet.
+    bool begin() {
+        _scanned = false;
+        return ready();
+    }
+    // Whether the region has been scanned, scanning it if EEPROM is ready.
+    bool ready() {
+        scan();
+        return _scanned;
+    }
+
+    // Copies the current value of id into out; false if there's none.
+    bool read(uint8_t id, void *out, uint8_t size) {
+        if (!ready() || id >= EEPROM_LOG_IDS || _current[id] < 0 || size > _valueSize) {
+            return false;
+        }
+        int at = address(_current[id]) + HeaderSize;
+        for (uint8_t i = 0; i < size; i++) {
+            ((uint8_t *)out)[i] = EEPROM.read(at + i);
+        }
+        return true;
+    }
+
+    // False if the value is too big, the id is out of range, every slot is
+    // current or EEPROM isn't ready.
+    bool write(uint8_t id, const void *data, uint8_t size) {
+        if (!ready() || id >= EEPROM_LOG_IDS || size > _valueSize) {
+            return false;
+        }
+        if (_current[id] >= 0 && same(_current[id], data, size)) {
+            return true;
+        }
+        int slot = freeSlot();
+        if (slot < 0) {
+            return false;
+        }
+        // Erase the id first and write it last, so until the record is
+        // complete the slot doesn't claim to be anything.
+        int at = address(slot);
+        update(at, Erased);
+        uint32_t sequence = _sequence + 1;
+        uint8_t crc = crc8(CrcStart, id);
+        for (uint8_t i = 0; i < 4; i++) {
+            uint8_t b = (uint8_t)(sequence >> (8 * i));
+            update(at + 1 + i, b);
+            crc = crc8(crc, b);
+        }
+        for (uint8_t i = 0; i < _valueSize; i++) {
+            uint8_t b = i < size ? ((const uint8_t *)data)[i] : 0;
+            update(at + HeaderSize + i, b);
+            crc = crc8(crc, b);
+        }
+        update(at + HeaderSize + _valueSize, crc);
+        update(at, id);
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP8266)
+        EEPROM.commit();
+#endif
+        _current[id] = slot;
+        _sequence = sequence;
+        _next = slot + 1 < _slots ? slot + 1 : 0;
+        return true;
+    }
+
+private:
+    int address(int slot) const { return _start + slot * slotSize(); }
+
+    static void update(int address, uint8_t value) {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ESP8266)
+        EEPROM.write(address, value); // only marks the page dirty if it differs
+#else
+        EEPROM.update(address, value);
+#endif
+    }
+
+    // CRC-8, polynomial 0x07, a byte at a time.
+    static uint8_t crc8(uint8_t crc, uint8_t b) {
+        crc ^= b;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+        return crc;
+    }
+
+    // Reads a slot's id and sequence; false if it's erased, zeroed or fails its CRC.
+    bool valid(int slot, uint8_t &id, uint32_t &sequence) const {
+        int at = address(slot);
+        id = EEPROM.read(at);
+        if (id == Erased || id >= EEPROM_LOG_IDS) {
+            return false;
+        }
+        uint8_t crc = CrcStart;
+        sequence = 0;
+        const uint8_t length = HeaderSize + _valueSize;
+        for (uint8_t i = 0; i < length; i++) {
+            uint8_t b = EEPROM.read(at + i);
+            if (i >= 1 && i < HeaderSize) {
+                sequence |= (uint32_t)b << (8 * (i - 1));
+            }
+            crc = crc8(crc, b);
+        }
+        return sequence != 0 && crc == EEPROM.read(at + length);
+    }
+
+    // Not until EEPROM covers the region: before EEPROM.begin() on ESP32 and
+    // ESP8266 every record would look missing, and writes would land on top
+    // of them.
+    void scan() {
+        if (_scanned || (long)EEPROM.length() < (long)_start + (long)_slots * slotSize()) {
+            return;
+        }
+        _scanned = true;
+        _sequence = 0;
+        _next = 0;
+        uint32_t newest[EEPROM_LOG_IDS];
+        for (uint8_t i = 0; i < EEPROM_LOG_IDS; i++) {
+            _current[i] = -1;
+        }
+        bool any = false;
+        for (int slot = 0; slot < _slots; slot++) {
+            uint8_t id;
+            uint32_t sequence;
+            if (!valid(slot, id, sequence)) {
+                continue;
+            }
+            if (_current[id] < 0 || sequence > newest[id]) {
+                _current[id] = slot;
+                newest[id] = sequence;
+            }
+            if (!any || sequence > _sequence) {
+                _sequence = sequence;
+                _next = slot + 1 < _slots ? slot + 1 : 0;
+                any = true;
+            }
+        }
+    }
+
+    bool same(int slot, const void *data, uint8_t size) const {
+        int at = address(slot) + HeaderSize;
+        for (uint8_t i = 0; i < size; i++) {
+            if (EEPROM.read(at + i) != ((const uint8_t *)data)[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool current(int slot) const {
+        for (uint8_t i = 0; i < EEPROM_LOG_IDS; i++) {
+            if (_current[i] == slot) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int freeSlot() const {
+        for (int n = 0, slot = _next; n < _slots; n++) {
+            if (!current(slot)) {
+                return slot;
+            }
+            slot = slot + 1 < _slots ? slot + 1 : 0;
+        }
+        return -1;
+    }
+};
+
 template <class T>
 class PersistentValue : private Scheduled {
     int _address;
+    EEPROMLog *_log;
+    uint8_t _id;
     T &_value;
     T _last;
     T _saved;
     long _writeDelayMs;
     Timer _writeTimer;
+    uint16_t _errors;
+    bool _loaded; // false while waiting for the EEPROMLog to be ready
 public:
     static const int Size = sizeof(T);
 
     PersistentValue(Schedule &schedule, int address, T &value, long writeDelayMs = 500) :
         Scheduled(schedule),
-        _address(address), _value(value),
+        _address(address), _log(0), _id(0), _value(value),
         _last(value), _saved(value),
-        _writeDelayMs(writeDelayMs), _writeTimer(0) {
+        _writeDelayMs(writeDelayMs), _writeTimer(0), _errors(0), _loaded(true) {
         EEPROM.get(_address, _value);
         _last = _value;
         _saved = _value;
     }
 
+    // Stored as record id in log; see EEPROMLog.  sizeof(T) must fit the log's values.
+    PersistentValue(Schedule &schedule, EEPROMLog &log, uint8_t id, T &value, long writeDelayMs = 500) :
+        Scheduled(schedule),
+        _address(0), _log(&log), _id(id), _value(value),
+        _last(value), _saved(value),
+        _writeDelayMs(writeDelayMs), _writeTimer(0), _errors(0), _loaded(false) {
+        static_assert(sizeof(T) <= 255, "EEPROMLog records hold at most 255 bytes");
+        if (sizeof(T) > log.valueSize()) {
+            _errors++; // will never load or save; see errors()
+        }
+        load();
+    }
+
     // Write defaultValue to EEPROM immediately and set value.
     // Call this on first flash to initialise the stored value.
     void reset(T defaultValue) {
@@ -76,27 +331,59 @@ public:
         save();
     }
 
-    // Force an immediate write regardless of the delay timer.
-    void save() {
-        EEPROM.put(_address, _value);
+    // Force an immediate write regardless of the delay timer.  False if it
+    // couldn't be stored (only possible with an EEPROMLog).
+    bool save() {
+        bool ok = write(_value);
         _last = _value;
         _saved = _value;
+        return ok;
     }
 
-    // Re-read from EEPROM, discarding any unsaved in-memory change.
+    // Saves that failed, plus one if T is too big for the EEPROMLog.
+    uint16_t errors() const { return _errors; }
+
+    // Re-read from EEPROM, discarding any unsaved in-memory change.  With an
+    // EEPROMLog that isn't ready yet, poll() tries again.
     void load() {
-        EEPROM.get(_address, _value);
+        if (_log) {
+            _loaded = _log->ready();
+            if (!_loaded) {
+                return;
+            }
+            _log->read(_id, &_value, sizeof(T));
+        } else {
+            EEPROM.get(_address, _value);
+        }
         _last = _value;
         _saved = _value;
     }
 
     void poll() override {
+        if (!_loaded) {
+            load();
+            if (!_loaded) {
+                return;
+            }
+        }
         if (_value != _last) {
             _last = _value;
             _writeTimer.reset(_writeDelayMs);
         } else if (_last != _saved && _writeTimer.expired()) {
-            EEPROM.put(_address, _last);
+            write(_last); // a failure is counted, not retried
             _saved = _last;
         }
     }
+private:
+    bool write(const T &value) {
+        if (!_log) {
+            EEPROM.put(_address, value);
+            return true;
+        }
+        if (!_log->write(_id, &value, sizeof(T))) {
+            _errors++;
+            return false;
+        }
+        return true;
+    }
 };
@@ -0,0 +1,268 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Scheduler.hpp>
+#include <SerialPlot.hpp>
+
+/*
+PlotCapture is a storage scope for Plotted channels.  SerialPlot can only
+show what happens to be true every 200ms; PlotCapture samples a few
+channels into a RAM ring on every poll (or from a timer), waits for a
+trigger, keeps going for the post-trigger samples and then prints the
+window as CSV a few rows per poll, long after the event.
+
+Channels and the trigger are picked by the names they were plotted under.
+The trigger fires when its channel crosses level going up (Capture_Rising),
+going down (Capture_Falling), either way (Capture_Either), or whenever it
+changes (Capture_Change).  The window is pre samples before the trigger,
+the trigger sample and post samples after it; pre + post + 1 is at most
+PLOT_CAPTURE_SAMPLES.  Values are stored as 16 bits and times as 16-bit
+microsecond gaps, so a sample costs 2 + 2 * PLOT_CAPTURE_CHANNELS bytes.
+
+MainSchedule schedule;
+PlotComposite channels;
+PlotCapture capture(schedule, channels);
+void setup() {
+	encoder.plot(channels, "enc");
+	PlotNum<int>::addToPlot(channels, "count", count);
+	capture.capture("enc.clock");
+	capture.capture("enc.data");
+	capture.capture("count");
+	capture.arm("count", Capture_Change, 0, 32, 31, true);  // re-arm after each dump
+	schedule.begin();
+}
+
+For a fixed rate, pass periodMicros, or pass PlotCapture::External and call
+sample() from a timer interrupt.
+*/
+
+#ifndef PLOT_CAPTURE_SAMPLES
+#if defined(__AVR__)
+#define PLOT_CAPTURE_SAMPLES 64
+#else
+#define PLOT_CAPTURE_SAMPLES 512
+#endif
+#endif
+
+#ifndef PLOT_CAPTURE_CHANNELS
+#define PLOT_CAPTURE_CHANNELS 4
+#endif
+
+enum CaptureTrigger {
+	Capture_Rising,
+	Capture_Falling,
+	Capture_Either,
+	Capture_Change
+};
+
+class PlotCapture : private Scheduled {
+public:
+	enum State { Idle, Armed, Triggered, Done };
+	static const unsigned long External = 0xFFFFFFFFUL;
+private:
+	PlotComposite &_plot;
+	Print &_out;
+	unsigned long _period;
+	uint8_t _rowsPerPoll;
+	Plotted *_channels[PLOT_CAPTURE_CHANNELS];
+	uint8_t _count;
+	Plotted *_trigger;
+	CaptureTrigger _kind;
+	long _level;
+	long _lastTrigger;
+	bool _primed;
+	bool _rearm;
+	uint16_t _pre;
+	uint16_t _post;
+	int16_t _values[PLOT_CAPTURE_SAMPLES][PLOT_CAPTURE_CHANNELS];
+	uint16_t _gap[PLOT_CAPTURE_SAMPLES]; // micros since the sample before
+	uint16_t _head;                       // slot for the next sample
+	uint16_t _filled;
+	uint16_t _remaining;                  // post-trigger samples still to take
+	uint16_t _triggerSlot;
+	unsigned long _lastSample;
+	volatile State _state;
+	// Dump progress
+	uint16_t _row;
+	long _time;
+
+public:
+	PlotCapture(Schedule &schedule, PlotComposite &plot, unsigned long periodMicros = 0, Print &out = Serial, uint8_t rowsPerPoll = 4) :
+		Scheduled(schedule), _plot(plot), _out(out), _period(periodMicros), _rowsPerPoll(rowsPerPoll),
+		_count(0), _trigger(0), _kind(Capture_Change), _level(0), _lastTrigger(0), _primed(false), _rearm(false),
+		_pre(0), _post(0), _head(0), _filled(0), _remaining(0), _triggerSlot(0), _lastSample(0), _state(Idle),
+		_row(0), _time(0) { }
+
+	// Adds a channel to the capture.  False if it isn't plotted or there's no room.
+	bool capture(const char *name) {
+		Plotted *p = find(name);
+		if (!p || _count >= PLOT_CAPTURE_CHANNELS || _state != Idle) return false;
+		_channels[_count++] = p;
+		return true;
+	}
+
+	// Starts filling the ring and watching for the trigger.  With rearm, the
+	// capture arms itself again once the window has been printed.
+	bool arm(const char *triggerName, CaptureTrigger kind, long level = 0, uint16_t pre = PLOT_CAPTURE_SAMPLES / 4, uint16_t post = PLOT_CAPTURE_SAMPLES / 2, bool rearm = false) {
+		Plotted *p = find(triggerName);
+		if (!p) return false;
+		if (pre > PLOT_CAPTURE_SAMPLES - 1) pre = PLOT_CAPTURE_SAMPLES - 1;
+		if (pre + post + 1 > PLOT_CAPTURE_SAMPLES) post = PLOT_CAPTURE_SAMPLES - 1 - pre;
+		_state = Idle;
+		_trigger = p;
+		_kind = kind;
+		_level = level;
+		_pre = pre;
+		_post = post;
+		_rearm = rearm;
+		restart();
+		return true;
+	}
+	void stop() {
+		_state = Idle;
+		_rearm = false;
+	}
+	State state() const { return _state; }
+
+	// Takes one sample if armed.  Safe to call from a timer interrupt.
+	void sample() {
+		State state = _state;
+		if (state != Armed && state != Triggered) return;
+		unsigned long now = micros();
+		uint16_t slot = _head;
+		unsigned long gap = _filled ? now - _lastSample : 0;
+		_gap[slot] = gap > 0xFFFF ? 0xFFFF : (uint16_t)gap;
+		_lastSample = now;
+		for (uint8_t i = 0; i < _count; i++) {
+			long v = _channels[i]->value();
+			_values[slot][i] = v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v;
+		}
+		_head = slot + 1 < PLOT_CAPTURE_SAMPLES ? slot + 1 : 0;
+		if (_filled < PLOT_CAPTURE_SAMPLES) _filled++;
+		if (state == Armed) {
+			long v = _trigger->value();
+			bool fire = _primed && _filled > _pre && fired(_lastTrigger, v);
+			_lastTrigger = v;
+			_primed = true;
+			if (!fire) return;
+			_triggerSlot = slot;
+			_remaining = _post;
+		} else {
+			_remaining--;
+		}
+		if (_remaining == 0) {
+			startDump();
+		} else {
+			_state = Triggered;
+		}
+	}
+
+	void poll() {
+		if (_state == Done) {
+			dump();
+			return;
+		}
+		if (_period == External) return;
+		if (_period && micros() - _lastSample < _period) return;
+		sample();
+	}
+
+private:
+	Plotted *find(const char *name) {
+		for (int i = 0; i < _plot.length(); i++) {
+			const char *n = _plot.item(i)->name();
+			if (n && !strcmp(n, name)) return _plot.item(i);
+		}
+		return 0;
+	}
+	bool fired(long was, long now) const {
+		bool up = was <= _level && now > _level;
+		bool down = was > _level && now <= _level;
+		switch (_kind) {
+			case Capture_Rising: return up;
+			case Capture_Falling: return down;
+			case Capture_Either: return up || down;
+			default: return was != now;
+		}
+	}
+	void restart() {
+		_head = 0;
+		_filled = 0;
+		_primed = false;
+		_state = Armed;
+	}
+	uint16_t slotOf(uint16_t row) const {
+		return (_triggerSlot + PLOT_CAPTURE_SAMPLES - _pre + row) % PLOT_CAPTURE_SAMPLES;
+	}
+	// Times are printed relative to the trigger sample.
+	void startDump() {
+		_row = 0;
+		_time = 0;
+		for (uint16_t row = 1; row <= _pre; row++) {
+			_time -= _gap[slotOf(row)];
+		}
+		_state = Done;
+	}
+	void dump() {
+		if (_row == 0) {
+			_out.print(F("# capture "));
+			_out.print(_trigger->name());
+			_out.print(F(", "));
+			_out.print(_pre);
+			_out.print(F(" before, "));
+			_out.print(_post);
+			_out.println(F(" after"));
+			_out.print(F("t_us"));
+			for (uint8_t i = 0; i < _count; i++) {
+				_out.print(',');
+				_out.print(_channels[i]->name());
+			}
+			_out.println();
+		}
+		const uint16_t rows = _pre + 1 + _post;
+		for (uint8_t n = 0; n < _rowsPerPoll && _row < rows; n++, _row++) {
+			uint16_t slot = slotOf(_row);
+			if (_row > 0) {
+				_time += _gap[slot];
+			}
+			_out.print(_time);
+			for (uint8_t i = 0; i < _count; i++) {
+				_out.print(',');
+				_out.print(_values[slot][i]);
+			}
+			_out.println();
+		}
+		if (_row >= rows) {
+			_out.println(F("# end"));
+			if (_rearm) {
+				restart();
+			} else {
+				_state = Idle;
+			}
+		}
+	}
+};
@@ -27,38 +27,150 @@ SOFTWARE.
 #include <Scheduler.hpp>
 #include <EdgeDetector.hpp>
 
+#ifndef SERIAL_PLOT_CHANNELS
+#define SERIAL_PLOT_CHANNELS 32 // channels that can be told apart by the filter; see Channels
+#endif
+#ifndef SERIAL_PLOT_POOL
+#define SERIAL_PLOT_POOL 8 // addToPlot() slots per value type
+#endif
+
+/*
+Which channels are shown.  Each Plotted is given a small id the first time
+it's plotted, and the filter is a bit per id, so the check made for every
+channel on every sample is one bit test.  Commands (+name, -name, ALL,
+NONE) find channels by a 16-bit hash of the name; they're rare, so a scan
+of the ids is fine there.  Naming a channel that hasn't been plotted yet is
+remembered until it turns up.  Channels plotted after ALL are shown, and
+after NONE are hidden.
+
+Past SERIAL_PLOT_CHANNELS there are no ids left.  Those channels still
+follow ALL and NONE but can't be picked out by name; unfiltered() counts
+them, so raise SERIAL_PLOT_CHANNELS if it isn't 0.
+*/
 class Channels {
-    List<String> _names;
+    static const uint8_t MaxPending = 4;
+    uint8_t _shown[(SERIAL_PLOT_CHANNELS + 7) / 8];
+    uint16_t _hash[SERIAL_PLOT_CHANNELS];
+    uint8_t _count;
+    bool _showNew;
+    uint16_t _pending[MaxPending];
+    bool _pendingShow[MaxPending];
+    uint8_t _pendingCount;
+    uint8_t _unfiltered;
 public:
-    Channels() { showAll(); }
-    void showAll() { _names.clear(); _names.add("ALL"); }
-    void showNone() { _names.clear(); }
-    bool contains(String name) const { return _names.contains("ALL") || _names.contains(name); }
-    bool add(String name) {
-        if (!_names.contains(name)) {
-            _names.add(name);
+    static const int8_t NoId = -1;
+    static const int8_t Full = -2;
+
+    Channels() : _count(0), _pendingCount(0), _unfiltered(0) { showAll(); }
+    void showAll() { fill(0xFF); _showNew = true; _pendingCount = 0; }
+    void showNone() { fill(0); _showNew = false; _pendingCount = 0; }
+    void add(String name) { show(name.c_str(), true); }
+    void remove(String name) { show(name.c_str(), false); }
+    bool contains(String name) const {
+        uint16_t h = hash(name.c_str());
+        for (uint8_t id = 0; id < _count; id++) {
+            if (_hash[id] == h) return shown(id);
         }
+        return _showNew;
     }
-    bool remove(String name) {
-        if (_names.contains(name)) {
-            _names.remove(name);
+    bool shown(int8_t id) const {
+        if (id == Full) return _showNew;
+        return id >= 0 && (_shown[id >> 3] & (1 << (id & 7)));
+    }
+    // Channels plotted after the ids ran out.
+    uint8_t unfiltered() const { return _unfiltered; }
+
+    // The id for a newly plotted channel, or Full.
+    int8_t intern(const char *name) {
+        if (_count >= SERIAL_PLOT_CHANNELS) {
+            if (_unfiltered < 255) _unfiltered++;
+            return Full;
         }
+        uint8_t id = _count++;
+        _hash[id] = hash(name);
+        set(id, _showNew);
+        for (uint8_t i = 0; i < _pendingCount; i++) {
+            if (_pending[i] == _hash[id]) {
+                set(id, _pendingShow[i]);
+            }
+        }
+        return id;
     }
+
+    // FNV-1a folded to 16 bits.
+    static uint16_t hash(const char *name) {
+        uint32_t h = 2166136261UL;
+        for (; name && *name; name++) {
+            h = (h ^ (uint8_t)*name) * 16777619UL;
+        }
+        return (uint16_t)(h ^ (h >> 16));
+    }
+
     void print() {
-        for (int i = 0; i < _names.length(); i++) {
-            if (i != 0) Serial.print(",");
-            Serial.print(_names[i]);
+        bool first = true;
+        for (uint8_t id = 0; id < _count; id++) {
+            if (!shown(id)) continue;
+            if (!first) Serial.print(",");
+            Serial.print(id);
+            first = false;
         }
     }
     void println() {
         print();
         Serial.println();
     }
+private:
+    void fill(uint8_t bits) {
+        for (uint8_t i = 0; i < sizeof(_shown); i++) {
+            _shown[i] = bits;
+        }
+    }
+    void set(uint8_t id, bool on) {
+        if (on) {
+            _shown[id >> 3] |= 1 << (id & 7);
+        } else {
+            _shown[id >> 3] &= ~(1 << (id & 7));
+        }
+    }
+    void show(const char *name, bool on) {
+        uint16_t h = hash(name);
+        bool found = false;
+        for (uint8_t id = 0; id < _count; id++) {
+            if (_hash[id] == h) {
+                set(id, on);
+                found = true;
+            }
+        }
+        if (found) {
+            return;
+        }
+        uint8_t i = 0;
+        while (i < _pendingCount && _pending[i] != h) i++;
+        if (i == _pendingCount) {
+            if (_pendingCount >= MaxPending) return;
+            _pendingCount++;
+        }
+        _pending[i] = h;
+        _pendingShow[i] = on;
+    }
 };
 
 class Plotted {
+    int8_t _id;
 public:
+    Plotted() : _id(Channels::NoId) { }
     virtual bool plot(Channels &channels, bool sep = false) = 0;
+    // For binary mode.  Plotted values that don't override these aren't sent.
+    virtual const char *name() const { return 0; }
+    virtual bool isBool() const { return false; }
+    virtual long value() const { return 0; }
+    // Whether the filter lets this channel through; interns it on first use.
+    bool shown(Channels &channels) {
+        if (_id == Channels::NoId) {
+            _id = channels.intern(name());
+        }
+        return channels.shown(_id);
+    }
 };
 
 class PlotComposite : public Composite<Plotted> {
@@ -74,46 +186,303 @@ public:
 
 class PlotBool : public Plotted {
     String _name;
-    bool &_value;
+    bool *_value;
+    PlotBool() : _value(0) { }
 public:
-    PlotBool(PlotComposite &plot, String name, bool &value) : _name(name), _value(value) { plot.add(this); }
+    PlotBool(PlotComposite &plot, String name, bool &value) : _name(name), _value(&value) { plot.add(this); }
+    const char *name() const { return _name.c_str(); }
+    bool isBool() const { return true; }
+    long value() const { return *_value; }
     bool plot(Channels &channels, bool sep = false) {
-        if (channels.contains(_name)) {
+        if (shown(channels)) {
             if (sep) {
                 Serial.print(",");
             }
             Serial.print(_name);
             Serial.print(":");
-            Serial.print(_value, DEC);
+            Serial.print(*_value, DEC);
             return true;
         }
         return false;
     }
-    static void addToPlot(PlotComposite &plot, String name, bool &value) {
-        new PlotBool(plot, name, value);
+    // Uses one of SERIAL_PLOT_POOL static slots; false when they're gone.
+    static bool addToPlot(PlotComposite &plot, String name, bool &value) {
+        static PlotBool pool[SERIAL_PLOT_POOL];
+        static uint8_t used = 0;
+        if (used >= SERIAL_PLOT_POOL) {
+            return false;
+        }
+        PlotBool &p = pool[used++];
+        p._name = name;
+        p._value = &value;
+        plot.add(&p);
+        return true;
     }
 };
 
 template <class T>
 class PlotNum : public Plotted {
     String _name;
-    T &_value;
+    T *_value;
+    PlotNum() : _value(0) { }
 public:
-    PlotNum(PlotComposite &plot, String name, T &value) : _name(name), _value(value) { plot.add(this); }
+    PlotNum(PlotComposite &plot, String name, T &value) : _name(name), _value(&value) { plot.add(this); }
+    const char *name() const { return _name.c_str(); }
+    long value() const { return (long)*_value; }
     bool plot(Channels &channels, bool sep = false) {
-        if (channels.contains(_name)) {
+        if (shown(channels)) {
             if (sep) {
                 Serial.print(",");
             }
             Serial.print(_name);
             Serial.print(":");
-            Serial.print(_value, DEC);
+            Serial.print(*_value, DEC);
             return true;
         }
         return false;
     }
-    static void addToPlot(PlotComposite &plot, String name, T &value) {
-        new PlotNum(plot, name, value);
+    // Uses one of SERIAL_PLOT_POOL static slots per T; false when they're gone.
+    static bool addToPlot(PlotComposite &plot, String name, T &value) {
+        static PlotNum pool[SERIAL_PLOT_POOL];
+        static uint8_t used = 0;
+        if (used >= SERIAL_PLOT_POOL) {
+            return false;
+        }
+        PlotNum &p = pool[used++];
+        p._name = name;
+        p._value = &value;
+        plot.add(&p);
+        return true;
+    }
+};
+
+/*
+Binary mode sends the shown channels as packed samples instead of text, so
+many channels can go out at kHz rates over the same link.  Send "BIN" to
+switch to it and "TEXT" to switch back, or call binary().  tools/plotdecode
+turns the stream back into CSV on the host.
+
+Frames are COBS encoded, so 0 only appears as the end of a frame and a
+receiver that starts mid-stream syncs at the next 0.  Inside a frame:
+  type byte, body, CRC-8 (polynomial 0x07) of the type and body.
+  'H' count              channels that follow; ids are 0 .. count-1
+  'N' id, kind, name     one per channel; kind 0 = bool, 1 = number
+  'K' micros, values     micros as 4 bytes little-endian, each value a zigzag
+                         varint
+  'D' dt, deltas         micros since the last sample as a varint, each
+                         value's change since the last sample as a zigzag
+                         varint
+Varints are LEB128, 7 bits per byte, low bits first.  A 'K' frame follows
+every header, every KeyEvery samples and any sample that had to be dropped
+because the serial buffer was full, so losing a frame only costs the
+samples up to the next 'K'.  The header is repeated every few key frames
+for receivers that attach late, and whenever the shown channels change.
+A frame bigger than the most the serial buffer has ever had room for (a
+'K' frame with many channels, against the 63 bytes an AVR UART or USB
+buffer holds) could never fit, so it's written anyway and blocks like the
+header.
+*/
+#ifndef SERIAL_PLOT_BINARY_CHANNELS
+#define SERIAL_PLOT_BINARY_CHANNELS 16 // shown channels sent in binary mode
+#endif
+static_assert(SERIAL_PLOT_BINARY_CHANNELS <= 48, "a binary plot frame has to fit in one COBS block");
+
+class PlotFrame {
+    // The biggest frame, a 'D' with every varint at its 5 byte worst case:
+    // type, dt, a value per channel, CRC.
+    static const uint8_t Size = 1 + 5 + SERIAL_PLOT_BINARY_CHANNELS * 5 + 1;
+    uint8_t _data[Size];
+    uint8_t _length;
+    bool _overflow;
+public:
+    PlotFrame() : _length(0), _overflow(false) { }
+    void begin(char type) {
+        _length = 0;
+        _overflow = false;
+        byte(type);
+    }
+    void byte(uint8_t b) {
+        if (_length < Size - 1) {
+            _data[_length++] = b;
+        } else {
+            _overflow = true;
+        }
+    }
+    void uint32(uint32_t v) {
+        for (uint8_t i = 0; i < 4; i++, v >>= 8) {
+            byte(v & 0xFF);
+        }
+    }
+    void varint(uint32_t v) {
+        while (v >= 0x80) {
+            byte((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        byte(v);
+    }
+    void zigzag(int32_t v) { varint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); }
+    // Cut short if need be so the terminating 0 still fits.
+    void text(const char *s) {
+        for (; s && *s && _length < Size - 2; s++) {
+            byte(*s);
+        }
+        byte(0);
+    }
+    // Bytes on the wire: CRC, one COBS code per 254 bytes, and the delimiter.
+    // Don't send a frame that overflowed; it would arrive with a good CRC.
+    int encodedLength() const { return _length + 3 + _length / 254; }
+    bool overflow() const { return _overflow; }
+
+    static uint8_t crc8(const uint8_t *data, uint8_t length) {
+        uint8_t crc = 0;
+        for (uint8_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            for (uint8_t b = 0; b < 8; b++) {
+                crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+            }
+        }
+        return crc;
+    }
+    // COBS: each run of non-zero bytes goes out after a code byte of its
+    // length + 1, which stands for the 0 that followed it.
+    void send(Print &out) {
+        _data[_length] = crc8(_data, _length);
+        const uint8_t total = _length + 1;
+        uint8_t start = 0;
+        while (true) {
+            uint8_t end = start;
+            while (end < total && _data[end] && end - start < 254) {
+                end++;
+            }
+            out.write((uint8_t)(end - start + 1));
+            out.write(_data + start, end - start);
+            if (end >= total) {
+                break;
+            }
+            // A full 254 byte run has no 0 after it to skip.
+            start = _data[end] ? end : end + 1;
+        }
+        out.write((uint8_t)0);
+    }
+};
+
+class BinaryPlot : private Scheduled {
+    static const uint8_t KeyEvery = 32;
+    static const uint8_t HeaderEvery = 16; // key frames
+    PlotComposite &_plot;
+    Channels &_channels;
+    Plotted *_shown[SERIAL_PLOT_BINARY_CHANNELS];
+    long _last[SERIAL_PLOT_BINARY_CHANNELS];
+    uint8_t _count;
+    PlotFrame _frame;
+    bool _on;
+    bool _header;
+    bool _key;
+    uint8_t _sinceKey;
+    uint8_t _keysSinceHeader;
+    unsigned long _period;
+    unsigned long _lastSample;
+    unsigned long _samples;
+    unsigned long _dropped;
+    int _room; // most availableForWrite() has reported
+public:
+    BinaryPlot(Schedule &schedule, PlotComposite &plot, Channels &channels) :
+        Scheduled(schedule), _plot(plot), _channels(channels), _count(0), _on(false), _header(true), _key(true),
+        _sinceKey(0), _keysSinceHeader(0), _period(1000), _lastSample(0), _samples(0), _dropped(0), _room(0) { }
+    void enable(bool on) {
+        _on = on;
+        _header = true;
+    }
+    bool enabled() const { return _on; }
+    void period(unsigned long us) { _period = us; }
+    // Call when the shown channels change.
+    void changed() { _header = true; }
+    unsigned long samples() const { return _samples; }
+    unsigned long dropped() const { return _dropped; }
+
+    void poll() {
+        if (!_on) {
+            return;
+        }
+        unsigned long now = micros();
+        if (now - _lastSample < _period) {
+            return;
+        }
+        if (_header && !sendHeader()) {
+            return;
+        }
+        bool key = _key || _sinceKey >= KeyEvery;
+        if (key) {
+            _frame.begin('K');
+            _frame.uint32(now);
+        } else {
+            _frame.begin('D');
+            _frame.varint(now - _lastSample);
+        }
+        // Read each value once: the deltas that follow have to be against
+        // what this frame sent, even if an ISR changes a value meanwhile.
+        long values[SERIAL_PLOT_BINARY_CHANNELS];
+        for (uint8_t i = 0; i < _count; i++) {
+            values[i] = _shown[i]->value();
+            _frame.zigzag(key ? values[i] : values[i] - _last[i]);
+        }
+        if (_frame.overflow()) {
+            _dropped++;
+            _key = true;
+            return;
+        }
+        // A sample that doesn't fit is dropped rather than blocking the loop;
+        // the next one is a key frame so the deltas stay right.  One that
+        // will never fit goes out anyway.
+        int room = Serial.availableForWrite();
+        if (room > _room) {
+            _room = room;
+        }
+        int length = _frame.encodedLength();
+        if (room < length && length <= _room) {
+            _dropped++;
+            _key = true;
+            return;
+        }
+        _frame.send(Serial);
+        for (uint8_t i = 0; i < _count; i++) {
+            _last[i] = values[i];
+        }
+        _lastSample = now;
+        _samples++;
+        _key = false;
+        _sinceKey = key ? 1 : _sinceKey + 1;
+        if (key && ++_keysSinceHeader >= HeaderEvery) {
+            _header = true;
+        }
+    }
+private:
+    // Blocks until the header is written; it's small and rare.
+    bool sendHeader() {
+        _count = 0;
+        for (int i = 0; i < _plot.length() && _count < SERIAL_PLOT_BINARY_CHANNELS; i++) {
+            Plotted *p = _plot.item(i);
+            if (p->name() && p->shown(_channels)) {
+                _shown[_count++] = p;
+            }
+        }
+        // An extra delimiter ends whatever text came before, so the header
+        // isn't lost in it.
+        Serial.write((uint8_t)0);
+        _frame.begin('H');
+        _frame.byte(_count);
+        _frame.send(Serial);
+        for (uint8_t i = 0; i < _count; i++) {
+            _frame.begin('N');
+            _frame.byte(i);
+            _frame.byte(_shown[i]->isBool() ? 0 : 1);
+            _frame.text(_shown[i]->name());
+            _frame.send(Serial);
+        }
+        _header = false;
+        _key = true;
+        _keysSinceHeader = 0;
+        return true;
     }
 };
 
@@ -121,14 +490,30 @@ class SerialPlot : public Clock, private EdgeDetectorBase, public PlotComposite
     Channels _channels;
     long _time;
     bool _clock;
+    BinaryPlot _binary;
     static const long DefaultTime = 200;
 public:
     SerialPlot(Schedule &schedule) :
         Clock(schedule, _time, _time, _clock),
         EdgeDetectorBase(schedule, _clock),
-        _time(DefaultTime >> 1) { enable(false); enable(true); }
-    void show(String channels) { _channels.add(channels); }
+        _time(DefaultTime >> 1), _binary(schedule, *this, _channels) { enable(false); enable(true); }
+    void show(String channels) {
+        _channels.add(channels);
+        _binary.changed();
+    }
+    // Binary mode, sampling every periodMicros; see above.
+    void binary(bool on, unsigned long periodMicros = 1000) {
+        _binary.period(periodMicros);
+        _binary.enable(on);
+    }
+    bool binary() const { return _binary.enabled(); }
+    unsigned long binaryDropped() const { return _binary.dropped(); }
+    // Channels past SERIAL_PLOT_CHANNELS, which +name/-name can't reach.
+    uint8_t unfilteredChannels() const { return _channels.unfiltered(); }
     void onRisingEdge() {
+        if (_binary.enabled()) {
+            return;
+        }
         if (plot(_channels)) {
             Serial.println();
         }
@@ -142,6 +527,9 @@ public:
             if (s == "NONE") { _channels.showNone(); }
             if (s[0] == '-') { _channels.remove(s.substring(1)); }
             if (s[0] == '+') { _channels.add(s.substring(1)); }
+            if (s == "BIN") { _binary.enable(true); }
+            if (s == "TEXT") { _binary.enable(false); }
+            _binary.changed();
         }
     }
 };
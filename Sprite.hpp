@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#pragma once
+
+#include <Graphics.hpp>
+
+/*
+1bpp sprites and tiles for page-organised framebuffers (SSD1306 and the
+like), drawn a byte at a time instead of a pixel at a time through
+Adafruit_GFX.
+
+Bitmaps are pre-packed the way the framebuffer is: one byte per column per
+8-pixel page, bit 0 at the top, pages one after another.  A sprite at a y
+that's a multiple of 8 is copied straight in; anywhere else each byte is
+split across two pages with a shift.  Sprite::at() gives the Rect it covers,
+for Drawable::bounds().
+
+const uint8_t ball[] PROGMEM = { 0x0E, 0x1F, 0x1F, 0x1F, 0x0E };
+Sprite ballSprite(5, 5, ball, true);
+... in draw(): PageFrame::of(display).blit(ballSprite, x, y);
+
+MainWindow redraws every drawable over the pixels that didn't change, so
+Blit_Set is the mode to use from draw(); the others are for drawing
+straight into a frame.
+*/
+
+enum BlitMode { Blit_Set, Blit_Erase, Blit_Invert };
+
+struct Sprite {
+  uint8_t width;
+  uint8_t height;
+  const uint8_t *data;
+  bool progmem;
+  Sprite(uint8_t w = 0, uint8_t h = 0, const uint8_t *bitmap = NULL, bool inProgmem = false) :
+    width(w), height(h), data(bitmap), progmem(inProgmem) { }
+  uint8_t pages() const { return (height + 7) >> 3; }
+  uint8_t column(uint8_t page, uint8_t x) const {
+    const uint8_t *p = data + page * width + x;
+    return progmem ? pgm_read_byte(p) : *p;
+  }
+  Rect<int16_t> at(int16_t x, int16_t y) const { return Rect<int16_t>(x, y, width, height); }
+};
+
+// A framebuffer laid out a page at a time, like Adafruit_SSD1306::getBuffer().
+class PageFrame {
+  uint8_t *_buffer;
+  int16_t _width;
+  int16_t _height;
+public:
+  PageFrame(uint8_t *buffer, int16_t width, int16_t height) : _buffer(buffer), _width(width), _height(height) { }
+  template <class TDisplay>
+  static PageFrame of(TDisplay &display) {
+    return PageFrame(display.getBuffer(), display.width(), display.height());
+  }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+  void blit(const Sprite &sprite, int16_t x, int16_t y, BlitMode mode = Blit_Set) {
+    int16_t x0 = x < 0 ? 0 : x;
+    int16_t x1 = x + sprite.width < _width ? x + sprite.width : _width;
+    if (x0 >= x1 || y >= _height || y + sprite.height <= 0) return;
+    uint8_t shift = y & 7;
+    int16_t page0 = (y - shift) / 8;
+    uint8_t pages = sprite.pages();
+    uint8_t lastMask = (sprite.height & 7) ? (1 << (sprite.height & 7)) - 1 : 0xFF;
+    for (uint8_t sp = 0; sp < pages; sp++) {
+      int16_t page = page0 + sp;
+      uint8_t mask = sp == pages - 1 ? lastMask : 0xFF;
+      for (int16_t col = x0; col < x1; col++) {
+        uint8_t bits = sprite.column(sp, col - x) & mask;
+        if (!bits) continue;
+        put(page, col, (uint8_t)(bits << shift), mode);
+        if (shift) {
+          put(page + 1, col, (uint8_t)(bits >> (8 - shift)), mode);
+        }
+      }
+    }
+  }
+  // Sets or clears every pixel in rect, a page-sized mask per column.
+  void fill(const Rect<int16_t> &rect, bool on = true) {
+    int16_t x0 = rect.left() < 0 ? 0 : rect.left();
+    int16_t x1 = rect.right() < _width ? rect.right() : _width;
+    int16_t y0 = rect.top() < 0 ? 0 : rect.top();
+    int16_t y1 = rect.bottom() < _height ? rect.bottom() : _height;
+    if (x0 >= x1 || y0 >= y1) return;
+    for (int16_t page = y0 >> 3; page <= (y1 - 1) >> 3; page++) {
+      int16_t top = page << 3;
+      uint8_t mask = 0xFF;
+      if (y0 > top) mask &= 0xFF << (y0 - top);
+      if (y1 < top + 8) mask &= 0xFF >> (top + 8 - y1);
+      uint8_t *p = _buffer + page * _width + x0;
+      for (int16_t col = x0; col < x1; col++, p++) {
+        if (on) *p |= mask;
+        else *p &= ~mask;
+      }
+    }
+  }
+private:
+  void put(int16_t page, int16_t col, uint8_t bits, BlitMode mode) {
+    if (page < 0 || page >= (_height + 7) >> 3) return;
+    uint8_t &b = _buffer[page * _width + col];
+    switch (mode) {
+      case Blit_Set: b |= bits; break;
+      case Blit_Erase: b &= ~bits; break;
+      case Blit_Invert: b ^= bits; break;
+    }
+  }
+};
+
+// A sprite that redraws only when it moves.
+template <class TDisplay>
+class SpriteDrawable : public Drawable<TDisplay> {
+  Sprite _sprite;
+  int16_t _x;
+  int16_t _y;
+  bool _visible;
+  int16_t _drawnX;
+  int16_t _drawnY;
+  bool _drawnVisible;
+  bool _drawn;
+public:
+  SpriteDrawable(MainWindow<TDisplay> &window, const Sprite &sprite, int16_t x = 0, int16_t y = 0) :
+    _sprite(sprite), _x(x), _y(y), _visible(true), _drawnX(x), _drawnY(y), _drawnVisible(true), _drawn(false) {
+    window.add(this);
+  }
+  void moveTo(int16_t x, int16_t y) { _x = x; _y = y; }
+  void visible(bool value) { _visible = value; }
+  void sprite(const Sprite &sprite) { _sprite = sprite; _drawn = false; }
+  int16_t x() const { return _x; }
+  int16_t y() const { return _y; }
+  void draw(TDisplay &display) {
+    if (_visible) {
+      PageFrame::of(display).blit(_sprite, _x, _y);
+    }
+    _drawnX = _x;
+    _drawnY = _y;
+    _drawnVisible = _visible;
+    _drawn = true;
+  }
+  bool bounds(Rect<int16_t> &rect) {
+    rect = _visible ? _sprite.at(_x, _y) : Rect<int16_t>();
+    return true;
+  }
+  bool changed() { return !_drawn || _x != _drawnX || _y != _drawnY || _visible != _drawnVisible; }
+};
+
+/*
+A background of 8x8 tiles, each 8 bytes packed like a sprite, so every cell
+is one page tall and lands on a page boundary when y is a multiple of 8.
+Tile 0 is taken to be blank and skipped.  Only the cells changed by set()
+since the last frame are reported as bounds(), so changing a tile resends
+just that part of the screen.
+
+const uint8_t tiles[][8] PROGMEM = { { 0 }, { 0xFF, 0x81, ... }, ... };
+TileLayer<Adafruit_SSD1306, 16, 8> level(window, tiles, true);
+level.set(3, 7, 1);
+*/
+template <class TDisplay, int TCols, int TRows>
+class TileLayer : public Drawable<TDisplay> {
+  const uint8_t (*_tiles)[8];
+  bool _progmem;
+  int16_t _x;
+  int16_t _y;
+  uint8_t _map[TRows][TCols];
+  Rect<int16_t> _dirty;
+public:
+  TileLayer(MainWindow<TDisplay> &window, const uint8_t (*tiles)[8], bool progmem = false, int16_t x = 0, int16_t y = 0) :
+    _tiles(tiles), _progmem(progmem), _x(x), _y(y) {
+    memset(_map, 0, sizeof(_map));
+    window.add(this);
+  }
+  uint8_t get(int col, int row) const { return _map[row][col]; }
+  void set(int col, int row, uint8_t tile) {
+    if (col < 0 || col >= TCols || row < 0 || row >= TRows) return;
+    if (_map[row][col] == tile) return;
+    _map[row][col] = tile;
+    _dirty.unite(Rect<int16_t>(_x + col * 8, _y + row * 8, 8, 8));
+  }
+  void fill(uint8_t tile) {
+    for (int row = 0; row < TRows; row++) {
+      for (int col = 0; col < TCols; col++) {
+        set(col, row, tile);
+      }
+    }
+  }
+  void draw(TDisplay &display) {
+    PageFrame frame = PageFrame::of(display);
+    for (int row = 0; row < TRows; row++) {
+      for (int col = 0; col < TCols; col++) {
+        uint8_t tile = _map[row][col];
+        if (tile) {
+          frame.blit(Sprite(8, 8, _tiles[tile], _progmem), _x + col * 8, _y + row * 8);
+        }
+      }
+    }
+    _dirty = Rect<int16_t>();
+  }
+  bool bounds(Rect<int16_t> &rect) {
+    rect = _dirty;
+    return true;
+  }
+  bool changed() { return !_dirty.empty(); }
+};
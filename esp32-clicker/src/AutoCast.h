@@ -1,6 +1,7 @@
 #pragma once
 #include "ClickerMode.h"
 #include "HID.h"
+#include "Format.h"
 #include <Arduino.h>
 
 // Repeatedly presses and releases a key or mouse button on configurable timing.
@@ -85,10 +86,11 @@ public:
             input[0] = (char)_key; input[1] = '\0';
         }
         char buf[128];
-        snprintf(buf, sizeof(buf),
-            "{\"mode\":\"AutoCast\",\"running\":%s"
-            ",\"input\":\"%s\",\"holdMs\":%u,\"waitMs\":%u}",
-            running() ? "true" : "false", input, _holdMs, _waitMs);
+        TextBuilder(buf)
+            .text("{\"mode\":\"AutoCast\",\"running\":").boolean(running())
+            .text(",\"input\":\"").text(input)
+            .text("\",\"holdMs\":").number(_holdMs)
+            .text(",\"waitMs\":").number(_waitMs).text("}");
         return String(buf);
     }
 };
@@ -0,0 +1,73 @@
+#include "DeferredLog.h"
+
+namespace DeferredLog {
+
+static constexpr uint8_t SIZE = 32;  // records, power of two
+
+struct Record {
+    uint32_t    time;
+    const char* format;
+    int32_t     a;
+    int32_t     b;
+};
+
+static Record            _ring[SIZE];
+static volatile uint8_t  _head = 0;   // next slot to write; writers only
+static volatile uint8_t  _tail = 0;   // next slot to read; drain() only
+static volatile uint32_t _dropped = 0;
+static uint32_t          _reportedDropped = 0;
+static portMUX_TYPE      _mux = portMUX_INITIALIZER_UNLOCKED;
+
+void IRAM_ATTR write(const char* format, int32_t a, int32_t b) {
+    uint32_t now = micros();
+    portENTER_CRITICAL_SAFE(&_mux);
+    uint8_t head = _head;
+    uint8_t next = (head + 1) & (SIZE - 1);
+    if (next == _tail) {
+        _dropped++;
+    } else {
+        Record& r = _ring[head];
+        r.time   = now;
+        r.format = format;
+        r.a      = a;
+        r.b      = b;
+        _head    = next;
+    }
+    portEXIT_CRITICAL_SAFE(&_mux);
+}
+
+int drain(Print& out, int maxRecords) {
+    int n = 0;
+    while (n < maxRecords && _tail != _head) {
+        Record r = _ring[_tail];
+        _tail = (_tail + 1) & (SIZE - 1);
+        out.printf("[%lu] ", (unsigned long)r.time);
+        out.printf(r.format, r.a, r.b);
+        out.println();
+        n++;
+    }
+    uint32_t d = _dropped;
+    if (d != _reportedDropped) {
+        out.printf("[log] dropped %lu\n", (unsigned long)(d - _reportedDropped));
+        _reportedDropped = d;
+    }
+    return n;
+}
+
+uint32_t dropped() { return _dropped; }
+
+uint32_t measure(int bursts) {
+    const int perBurst = SIZE - 1;
+    uint32_t total = 0;
+    for (int i = 0; i < bursts; i++) {
+        _tail = _head;
+        uint32_t start = micros();
+        for (int j = 0; j < perBurst; j++)
+            write("measure %d %d", i, j);
+        total += micros() - start;
+    }
+    _tail = _head;
+    return total * 1000UL / (uint32_t)(bursts * perBurst);
+}
+
+} // namespace DeferredLog
@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+// Forked from jffordem_Scheduler/DeferredLog.hpp.
+// Changes from original:
+//   - No Scheduler dependency; call DeferredLog::drain() from loop()
+//   - Always enabled (no DEFERRED_LOG switch), ESP32 spinlock only
+//   - Drains with Serial.printf: every argument is 32 bits on ESP32, the same
+//     size printf reads for %d/%u/%x/%c/%s, so no hand-rolled formatter
+//
+// LOG_DEFER*() only copies the format pointer and up to two values into a
+// ring, so it's safe on the HID hot path and in ISRs. %s arguments must
+// outlive the record (string literals).
+#define LOG_DEFER(fmt)        DeferredLog::write((fmt), 0, 0)
+#define LOG_DEFER1(fmt, a)    DeferredLog::write((fmt), (int32_t)(a), 0)
+#define LOG_DEFER2(fmt, a, b) DeferredLog::write((fmt), (int32_t)(a), (int32_t)(b))
+
+namespace DeferredLog {
+    void     write(const char* format, int32_t a, int32_t b);
+    // Prints up to maxRecords queued records as "[micros] text". Returns how many.
+    int      drain(Print& out, int maxRecords = 4);
+    uint32_t dropped();
+    // Average nanoseconds per write(), timed over bursts that fit in the ring.
+    uint32_t measure(int bursts = 8);
+}
@@ -1,4 +1,5 @@
 #include "HID.h"
+#include "DeferredLog.h"
 
 #ifdef USB_HID_MODE
 static USBHIDKeyboard _kb;
@@ -16,14 +17,14 @@ void begin() {
 }
 
 void pressKey(uint8_t code) {
-    Serial.printf("[HID] KEY PRESS   0x%02X\n", code);
+    LOG_DEFER1("[HID] KEY PRESS   0x%02X", code);
 #ifdef USB_HID_MODE
     _kb.press(code);
 #endif
 }
 
 void releaseKey(uint8_t code) {
-    Serial.printf("[HID] KEY RELEASE 0x%02X\n", code);
+    LOG_DEFER1("[HID] KEY RELEASE 0x%02X", code);
 #ifdef USB_HID_MODE
     _kb.release(code);
 #endif
@@ -40,21 +41,21 @@ static const char* mouseButtonName(uint8_t button) {
 }
 
 void pressMouse(uint8_t button) {
-    Serial.printf("[HID] MOUSE PRESS   %s\n", mouseButtonName(button));
+    LOG_DEFER1("[HID] MOUSE PRESS   %s", mouseButtonName(button));
 #ifdef USB_HID_MODE
     _ms.press(button);
 #endif
 }
 
 void releaseMouse(uint8_t button) {
-    Serial.printf("[HID] MOUSE RELEASE %s\n", mouseButtonName(button));
+    LOG_DEFER1("[HID] MOUSE RELEASE %s", mouseButtonName(button));
 #ifdef USB_HID_MODE
     _ms.release(button);
 #endif
 }
 
 void releaseAll() {
-    Serial.println("[HID] RELEASE ALL");
+    LOG_DEFER("[HID] RELEASE ALL");
 #ifdef USB_HID_MODE
     _kb.releaseAll();
     _ms.release(MOUSE_LEFT | MOUSE_RIGHT | MOUSE_MIDDLE);
@@ -1,6 +1,7 @@
 #pragma once
 #include "ClickerMode.h"
 #include "HID.h"
+#include "Format.h"
 #include <Arduino.h>
 
 // Holds a mouse button or key down until stopped.
@@ -53,9 +54,9 @@ public:
             input[0] = (char)_key; input[1] = '\0';
         }
         char buf[80];
-        snprintf(buf, sizeof(buf),
-            "{\"mode\":\"Hold\",\"running\":%s,\"input\":\"%s\"}",
-            _running ? "true" : "false", input);
+        TextBuilder(buf)
+            .text("{\"mode\":\"Hold\",\"running\":").boolean(_running)
+            .text(",\"input\":\"").text(input).text("\"}");
         return String(buf);
     }
 };
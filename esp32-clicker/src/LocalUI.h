@@ -5,6 +5,8 @@
 #include <LiquidCrystal_I2C.h>
 #include "ClickerMode.h"
 #include "ClickerCmd.h"
+#include "PcntEncoder.h"
+#include "Format.h"
 
 // Local hardware UI: 4×20 I2C LCD + two push-button encoder wheels.
 //
@@ -13,6 +15,9 @@
 // Encoder B: placeholder — rotate and press currently unmapped.
 //            Future intent: A press = enable left mouse, B press = enable right mouse.
 //
+// Both wheels are counted by PCNT units (see PcntEncoder.h), so turns aren't
+// missed while Wi-Fi or the web server hold up loop().
+//
 // Pin assignments:
 //   Encoder A  CLK=GPIO1  DT=GPIO2  SW=GPIO42
 //   Encoder B  CLK=GPIO41  DT=GPIO40  SW=GPIO39
@@ -40,8 +45,8 @@ public:
         pinMode(ENC_B_DT,  INPUT_PULLUP);
         pinMode(ENC_B_SW,  INPUT_PULLUP);
 
-        _aClkLast = digitalRead(ENC_A_CLK);
-        _bClkLast = digitalRead(ENC_B_CLK);
+        if (!_encA.begin()) Serial.println("[UI] Encoder A: no PCNT unit, polling");
+        if (!_encB.begin()) Serial.println("[UI] Encoder B: no PCNT unit, polling");
 
         Wire.begin(I2C_SDA, I2C_SCL);
         Wire.setClock(400000);
@@ -54,7 +59,7 @@ public:
             Wire.beginTransmission(addr);
             if (Wire.endTransmission() == 0) {
                 char buf[8];
-                snprintf(buf, sizeof(buf), "\"0x%02X\"", addr);
+                TextBuilder(buf).text("\"0x").hex(addr, 2).text("\"");
                 if (!first) _i2cScanJson += ",";
                 _i2cScanJson += buf;
                 first = false;
@@ -91,7 +96,6 @@ public:
 
 private:
     static constexpr uint32_t LCD_PERIOD_MS  = 100;
-    static constexpr uint32_t ENC_GAP_MS    = 5;     // min ms between encoder ticks
     static constexpr int32_t  HOLD_MS_MIN   = 50;
     static constexpr int32_t  HOLD_MS_MAX   = 3000;
     static constexpr int32_t  HOLD_MS_STEP  = 50;
@@ -109,10 +113,8 @@ private:
     uint32_t           _lastLcdMs = 0;
     char               _shadow[4][21] = {};
 
-    bool     _aClkLast = HIGH;
-    uint32_t _aEncLast = 0;
-    bool     _bClkLast = HIGH;
-    uint32_t _bEncLast = 0;
+    PcntEncoder _encA{ENC_A_CLK, ENC_A_DT};
+    PcntEncoder _encB{ENC_B_CLK, ENC_B_DT};
 
     // Fires true exactly once per confirmed button press (active-low, debounced).
     struct BtnDebounce {
@@ -134,20 +136,15 @@ private:
     void pushCmd(ClickerCmd cmd) { xQueueSend(cmdQueue, &cmd, 0); }
 
     void tickEncoderA(uint32_t now, ClickerMode* activeMode) {
-        bool clk = digitalRead(ENC_A_CLK);
-        if (clk == HIGH && _aClkLast == LOW && (now - _aEncLast) >= ENC_GAP_MS) {
-            _aEncLast = now;
-            if (digitalRead(ENC_A_DT) == LOW)
-                _holdMs = min(HOLD_MS_MAX, _holdMs + HOLD_MS_STEP);
-            else
-                _holdMs = max(HOLD_MS_MIN, _holdMs - HOLD_MS_STEP);
+        int32_t detents = _encA.poll();
+        if (detents) {
+            _holdMs = constrain(_holdMs + detents * HOLD_MS_STEP, HOLD_MS_MIN, HOLD_MS_MAX);
 
             ClickerCmd c{}; c.type = ClickerCmd::SET_PARAM;
             strncpy(c.paramKey, "holdMs", sizeof(c.paramKey) - 1);
-            snprintf(c.paramVal, sizeof(c.paramVal), "%ld", (long)_holdMs);
+            Format::decimal(c.paramVal, sizeof(c.paramVal), _holdMs);
             pushCmd(c);
         }
-        _aClkLast = clk;
 
         if (_aSw.pressed(ENC_A_SW, now)) {
             ClickerCmd c{};
@@ -158,20 +155,15 @@ private:
     }
 
     void tickEncoderB(uint32_t now) {
-        bool clk = digitalRead(ENC_B_CLK);
-        if (clk == HIGH && _bClkLast == LOW && (now - _bEncLast) >= ENC_GAP_MS) {
-            _bEncLast = now;
-            if (digitalRead(ENC_B_DT) == LOW)
-                _waitMs = min(WAIT_MS_MAX, _waitMs + WAIT_MS_STEP);
-            else
-                _waitMs = max(WAIT_MS_MIN, _waitMs - WAIT_MS_STEP);
+        int32_t detents = _encB.poll();
+        if (detents) {
+            _waitMs = constrain(_waitMs + detents * WAIT_MS_STEP, WAIT_MS_MIN, WAIT_MS_MAX);
 
             ClickerCmd c{}; c.type = ClickerCmd::SET_PARAM;
             strncpy(c.paramKey, "waitMs", sizeof(c.paramKey) - 1);
-            snprintf(c.paramVal, sizeof(c.paramVal), "%ld", (long)_waitMs);
+            Format::decimal(c.paramVal, sizeof(c.paramVal), _waitMs);
             pushCmd(c);
         }
-        _bClkLast = clk;
         _bSw.pressed(ENC_B_SW, now);
     }
 
@@ -186,17 +178,16 @@ private:
         if (!_lcd) return;
         char row[21];
 
-        snprintf(row, sizeof(row), "%-20s", activeMode ? activeMode->name() : "---");
+        TextBuilder(row).text(activeMode ? activeMode->name() : "---", 20);
         lcdRow(0, row);
 
-        snprintf(row, sizeof(row), "%-20s",
-                 (activeMode && activeMode->running()) ? "[RUNNING]" : "[STOPPED]");
+        TextBuilder(row).text((activeMode && activeMode->running()) ? "[RUNNING]" : "[STOPPED]", 20);
         lcdRow(1, row);
 
-        snprintf(row, sizeof(row), "H:%4ldms W:%4ldms   ", (long)_holdMs, (long)_waitMs);
+        TextBuilder(row).text("H:").number(_holdMs, 4).text("ms W:").number(_waitMs, 4).text("ms   ");
         lcdRow(2, row);
 
-        snprintf(row, sizeof(row), "%-20s", WiFi.localIP().toString().c_str());
+        TextBuilder(row).text(WiFi.localIP().toString().c_str(), 20);
         lcdRow(3, row);
     }
 };
@@ -0,0 +1,108 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/pulse_cnt.h>
+
+// Forked from jffordem_Scheduler/EncoderWheel.hpp EncoderWheelHandler (PCNT backend).
+// Changes from original:
+//   - No Scheduler dependency; poll() returns the detent delta instead of
+//     calling handleInput() once per detent
+//   - No acceleration, velocity or plotting
+//   - Fixed at one count per detent (Encoder_1x)
+//
+// Counts quadrature in a PCNT unit: every edge on either pin is a quarter
+// step, with direction from the level of the other pin.  The hardware sees
+// every edge, so no ticks are lost while Wi-Fi or the web server hold up
+// loop().  Glitches under 1us are filtered in hardware and the 16-bit counter
+// is extended by the driver (accum_count), so poll() only reads back a count.
+// Positive = clockwise (DT low when CLK rises).
+//
+// If no PCNT unit is free, poll() falls back to decoding the pins itself.
+class PcntEncoder {
+public:
+    PcntEncoder(uint8_t clkPin, uint8_t dtPin) : _clkPin(clkPin), _dtPin(dtPin) {}
+
+    // Call after pinMode(INPUT_PULLUP) on both pins.
+    bool begin() {
+        _state = readState();
+        pcnt_unit_config_t unitConfig = {};
+        unitConfig.low_limit  = -32768;
+        unitConfig.high_limit = 32767;
+        unitConfig.flags.accum_count = 1;
+        if (pcnt_new_unit(&unitConfig, &_unit) != ESP_OK) {
+            _unit = nullptr;
+            return false;
+        }
+        pcnt_glitch_filter_config_t filter = {};
+        filter.max_glitch_ns = 1000;
+        pcnt_unit_set_glitch_filter(_unit, &filter);
+
+        pcnt_chan_config_t clkConfig = {};
+        clkConfig.edge_gpio_num  = _clkPin;
+        clkConfig.level_gpio_num = _dtPin;
+        pcnt_channel_handle_t clkChannel = nullptr;
+        pcnt_new_channel(_unit, &clkConfig, &clkChannel);
+        pcnt_channel_set_edge_action(clkChannel, PCNT_CHANNEL_EDGE_ACTION_DECREASE, PCNT_CHANNEL_EDGE_ACTION_INCREASE);
+        pcnt_channel_set_level_action(clkChannel, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+
+        pcnt_chan_config_t dtConfig = {};
+        dtConfig.edge_gpio_num  = _dtPin;
+        dtConfig.level_gpio_num = _clkPin;
+        pcnt_channel_handle_t dtChannel = nullptr;
+        pcnt_new_channel(_unit, &dtConfig, &dtChannel);
+        pcnt_channel_set_edge_action(dtChannel, PCNT_CHANNEL_EDGE_ACTION_INCREASE, PCNT_CHANNEL_EDGE_ACTION_DECREASE);
+        pcnt_channel_set_level_action(dtChannel, PCNT_CHANNEL_LEVEL_ACTION_KEEP, PCNT_CHANNEL_LEVEL_ACTION_INVERSE);
+
+        // accum_count only carries past the limits if there are watch points on them.
+        pcnt_unit_add_watch_point(_unit, unitConfig.low_limit);
+        pcnt_unit_add_watch_point(_unit, unitConfig.high_limit);
+        pcnt_unit_enable(_unit);
+        pcnt_unit_clear_count(_unit);
+        pcnt_unit_start(_unit);
+        return true;
+    }
+
+    bool hardware() const { return _unit != nullptr; }
+
+    // Detents turned since the last call.
+    int32_t poll() {
+        if (_unit) {
+            int now = 0;
+            pcnt_unit_get_count(_unit, &now);
+            _quarters += (int32_t)((uint32_t)now - (uint32_t)_lastCount);
+            _lastCount = now;
+        } else {
+            _quarters += decode();
+        }
+        int32_t detents = _quarters / QUARTERS_PER_DETENT;
+        _quarters -= detents * QUARTERS_PER_DETENT;
+        return detents;
+    }
+
+private:
+    static constexpr int32_t QUARTERS_PER_DETENT = 4;
+
+    uint8_t            _clkPin;
+    uint8_t            _dtPin;
+    pcnt_unit_handle_t _unit      = nullptr;
+    int                _lastCount = 0;
+    int32_t            _quarters  = 0;
+    uint8_t            _state     = 3;
+
+    uint8_t readState() const {
+        return (digitalRead(_clkPin) << 1) | digitalRead(_dtPin);
+    }
+
+    // Same transition table as QuadratureDecoder; a double step is dropped.
+    int8_t decode() {
+        static const int8_t quarters[16] = {
+             0, -1, +1,  0,
+            +1,  0,  0, -1,
+            -1,  0,  0, +1,
+             0, +1, -1,  0
+        };
+        uint8_t state = readState();
+        int8_t q = quarters[(_state << 2) | state];
+        _state = state;
+        return q;
+    }
+};
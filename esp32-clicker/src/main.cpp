@@ -5,6 +5,7 @@
 #include "secrets.h"
 #include "ClickerCmd.h"
 #include "HID.h"
+#include "DeferredLog.h"
 #include "ClickerMode.h"
 #include "WebUI.h"
 #include "AutoCast.h"
@@ -121,6 +122,7 @@ void setup() {
     activeMode = modes[0];
     webui_push(activeMode->statusJson());
     Serial.println("Web server started.");
+    Serial.printf("Deferred log call: %lu ns\n", (unsigned long)DeferredLog::measure());
 }
 
 void loop() {
@@ -149,4 +151,7 @@ void loop() {
     }
 
     webui_cleanup();
+
+    // HID diagnostics are queued on the hot path; print a few per pass.
+    DeferredLog::drain(Serial);
 }
@@ -0,0 +1,161 @@
+#pragma once
+#include <Arduino.h>
+
+// Forked from jffordem_Scheduler/Format.hpp.
+// Changes from original:
+//   - No Scheduler dependency
+//   - No measure(); printf is in the ESP32 ROM anyway, so this saves time
+//     per status push rather than flash
+//
+// Allocation-free number formatting and a TextBuilder for the status JSON
+// and LCD rows.  Output is truncated to fit and always NUL-terminated.  A
+// negative width left-justifies.
+
+namespace Format {
+    // Digits of value in base, least significant first.  Values that fit in
+    // 16 bits use 16-bit division, which is several times cheaper on AVR.
+    inline int digits(char *rev, unsigned long value, uint8_t base, char hexA) {
+        int n = 0;
+        while (value > 0xFFFFUL) {
+            uint8_t d = value % base;
+            rev[n++] = d < 10 ? '0' + d : hexA + d - 10;
+            value /= base;
+        }
+        uint16_t small = (uint16_t)value;
+        do {
+            uint8_t d = small % base;
+            rev[n++] = d < 10 ? '0' + d : hexA + d - 10;
+            small /= base;
+        } while (small);
+        return n;
+    }
+
+    inline int layout(char *out, int size, unsigned long magnitude, char sign, uint8_t base, uint8_t decimals, int width, char pad, char hexA = 'A') {
+        if (size <= 0) {
+            return 0;
+        }
+        char rev[24];
+        int n = digits(rev, magnitude, base, hexA);
+        if (decimals > 9) {
+            decimals = 9;
+        }
+        while (n <= decimals) {
+            rev[n++] = '0';
+        }
+        bool left = width < 0;
+        if (left) {
+            width = -width;
+        }
+        int body = n + (decimals ? 1 : 0) + (sign ? 1 : 0);
+        int fill = width > body ? width - body : 0;
+        int len = 0;
+#define FORMAT_PUT(c) do { if (len < size - 1) out[len++] = (c); } while (0)
+        if (!left && pad != '0') {
+            for (; fill > 0; fill--) FORMAT_PUT(' ');
+        }
+        if (sign) {
+            FORMAT_PUT(sign);
+        }
+        if (!left && pad == '0') {
+            for (; fill > 0; fill--) FORMAT_PUT('0');
+        }
+        while (n > 0) {
+            if (decimals && n == decimals) {
+                FORMAT_PUT('.');
+            }
+            n--;
+            FORMAT_PUT(rev[n]);
+        }
+        for (; fill > 0; fill--) FORMAT_PUT(' ');
+#undef FORMAT_PUT
+        out[len] = 0;
+        return len;
+    }
+
+    // plus puts a '+' in front of positive values.
+    inline int decimal(char *out, int size, long value, int width = 0, char pad = ' ', bool plus = false) {
+        bool negative = value < 0;
+        unsigned long magnitude = negative ? -(unsigned long)value : (unsigned long)value;
+        return layout(out, size, magnitude, negative ? '-' : (plus && value ? '+' : 0), 10, 0, width, pad);
+    }
+
+    inline int unsignedDecimal(char *out, int size, unsigned long value, int width = 0, char pad = ' ') {
+        return layout(out, size, value, 0, 10, 0, width, pad);
+    }
+
+    // value is in units of 10^-decimals: fixed(out, size, -5, 2) is "-0.05".
+    inline int fixed(char *out, int size, long value, uint8_t decimals, int width = 0, char pad = ' ') {
+        bool negative = value < 0;
+        unsigned long magnitude = negative ? -(unsigned long)value : (unsigned long)value;
+        return layout(out, size, magnitude, negative ? '-' : 0, 10, decimals, width, pad);
+    }
+
+    // digits is the minimum number of hex digits, zero-filled.
+    inline int hex(char *out, int size, unsigned long value, int digits = 0, bool upper = true) {
+        return layout(out, size, value, 0, 16, 0, digits, '0', upper ? 'A' : 'a');
+    }
+}
+
+class TextBuilder {
+    char *_buffer;
+    int _size;
+    int _length;
+public:
+    TextBuilder(char *buffer, int size) : _buffer(buffer), _size(size), _length(0) {
+        if (_size > 0) {
+            _buffer[0] = 0;
+        }
+    }
+    template <int TSize>
+    TextBuilder(char (&buffer)[TSize]) : _buffer(buffer), _size(TSize), _length(0) {
+        _buffer[0] = 0;
+    }
+    TextBuilder &text(const char *text) {
+        while (text && *text && room()) {
+            _buffer[_length++] = *text++;
+        }
+        return terminate();
+    }
+    TextBuilder &ch(char c) {
+        if (room()) {
+            _buffer[_length++] = c;
+        }
+        return terminate();
+    }
+    // Left-justifies text in width columns, like "%-20s".
+    TextBuilder &text(const char *text, int width) {
+        int start = _length;
+        this->text(text);
+        while (_length - start < width && room()) {
+            _buffer[_length++] = ' ';
+        }
+        return terminate();
+    }
+    TextBuilder &number(long value, int width = 0, char pad = ' ') {
+        _length += Format::decimal(end(), space(), value, width, pad);
+        return *this;
+    }
+    TextBuilder &fixed(long value, uint8_t decimals, int width = 0, char pad = ' ') {
+        _length += Format::fixed(end(), space(), value, decimals, width, pad);
+        return *this;
+    }
+    TextBuilder &hex(unsigned long value, int digits = 0) {
+        _length += Format::hex(end(), space(), value, digits);
+        return *this;
+    }
+    TextBuilder &boolean(bool value) {
+        return text(value ? "true" : "false");
+    }
+    const char *c_str() const { return _buffer; }
+    int length() const { return _length; }
+private:
+    bool room() const { return _length < _size - 1; }
+    char *end() { return _buffer + _length; }
+    int space() const { return _size - _length; }
+    TextBuilder &terminate() {
+        if (_size > 0) {
+            _buffer[_length] = 0;
+        }
+        return *this;
+    }
+};
@@ -3,6 +3,7 @@
 #include <esp_random.h>
 #include "MorseEngine.h"
 #include "Timer.h"
+#include "Format.h"
 
 class KochTrainer {
 public:
@@ -86,28 +87,22 @@ public:
     }
 
     String statusJson() const {
-        char lastSentJson[6]   = "\"\"";
-        char lastAnswerJson[6] = "\"\"";
-        if (_revealed && _lastSent)
-            snprintf(lastSentJson,   sizeof(lastSentJson),   "\"%c\"", _lastSent);
-        if (_revealed && _lastAnswer[0])
-            snprintf(lastAnswerJson, sizeof(lastAnswerJson), "\"%c\"", _lastAnswer[0]);
-
         int pct = _total > 0 ? (_correct * 100 / _total) : 0;
         char buf[320];
-        snprintf(buf, sizeof(buf),
-            "{\"running\":%s,\"kochLevel\":%d,\"charWpm\":%d,\"effectiveWpm\":%d,"
-            "\"lastSent\":%s,\"revealed\":%s,\"lastAnswer\":%s,\"lastCorrect\":%s,"
-            "\"correct\":%d,\"total\":%d,\"pct\":%d}",
-            running()    ? "true" : "false",
-            _kochLevel,
-            _engine.charWpm(),
-            _engine.effectiveWpm(),
-            lastSentJson,
-            _revealed    ? "true" : "false",
-            lastAnswerJson,
-            _lastCorrect ? "true" : "false",
-            _correct, _total, pct);
+        TextBuilder json(buf);
+        json.text("{\"running\":").boolean(running())
+            .text(",\"kochLevel\":").number(_kochLevel)
+            .text(",\"charWpm\":").number(_engine.charWpm())
+            .text(",\"effectiveWpm\":").number(_engine.effectiveWpm())
+            .text(",\"lastSent\":");
+        quotedChar(json, _revealed ? _lastSent : 0);
+        json.text(",\"revealed\":").boolean(_revealed)
+            .text(",\"lastAnswer\":");
+        quotedChar(json, _revealed ? _lastAnswer[0] : 0);
+        json.text(",\"lastCorrect\":").boolean(_lastCorrect)
+            .text(",\"correct\":").number(_correct)
+            .text(",\"total\":").number(_total)
+            .text(",\"pct\":").number(pct).text("}");
         return String(buf);
     }
 
@@ -135,4 +130,11 @@ private:
         _engine.send(msg);
         _state = SENDING;
     }
+
+    // "\"c\"", or "\"\"" for none.
+    static void quotedChar(TextBuilder& json, char c) {
+        json.text("\"");
+        if (c) json.ch(c);
+        json.text("\"");
+    }
 };
@@ -29,14 +29,26 @@ SOFTWARE.
  * encoder push buttons.
  *
  * It prints the current encoder counts and button press state over Serial.
+ * The encoder's own diagnostics go through DeferredLog, so the ISR only
+ * queues a record and DeferredLogPrinter prints it later from the loop.
+ *
+ * PlotCapture watches the left encoder: whenever its value changes, the raw
+ * clock and data levels around the change are printed as CSV, so a miscount
+ * can be lined up against the edges that caused it.  Press the left switch
+ * to arm the next capture.
  *
  * The board config header is selected automatically for Leonardo/Pro Micro
  * versus R4 Minima. Update the pin mappings if you have a different wiring.
  */
 
+#define DEFERRED_LOG 1
+
 #include <Scheduler.hpp>
+#include <DeferredLog.hpp>
 #include <EncoderWheel.hpp>
 #include <ButtonHandler.hpp>
+#include <PinIO.hpp>
+#include <PlotCapture.hpp>
 
 #if defined(__AVR_ATmega32U4__)
   #include <LeonardoConfig.hpp>
@@ -53,6 +65,7 @@ SOFTWARE.
 #endif
 
 MainSchedule schedule;
+DeferredLogPrinter logPrinter(schedule);
 
 int leftEncoderValue = 0;
 int rightEncoderValue = 0;
@@ -61,11 +74,22 @@ int rightButtonPresses = 0;
 bool leftButtonDown = false;
 bool rightButtonDown = false;
 unsigned long lastReport = 0;
+bool leftClockLevel = false;
+bool leftDataLevel = false;
+
+PlotComposite captureChannels;
+PlotCapture capture(schedule, captureChannels);
+
+void armCapture() {
+    // 24 samples before the count changes and 16 after.
+    capture.arm("L.value", Capture_Change, 0, 24, 16);
+}
 
 void onLeftButtonPress() {
     leftButtonDown = true;
     leftButtonPresses++;
     Serial.println("LEFT BUTTON PRESSED");
+    armCapture();
 }
 
 void onLeftButtonRelease() {
@@ -100,6 +124,9 @@ InterruptEncoderWheel rightEncoder(
     1000,
     1);
 
+DigitalRead leftClockRead(schedule, ENCODER_LEFT.Encoder.clockPin, leftClockLevel);
+DigitalRead leftDataRead(schedule, ENCODER_LEFT.Encoder.dataPin, leftDataLevel);
+
 ButtonHandler leftEncoderButton(
     schedule,
     LEFT_BUTTON,
@@ -140,6 +167,17 @@ void setup() {
     Serial.println(ENCODER_RIGHT.Encoder.dataPin);
 #endif
     Serial.println("Press the left/right switches to see button state and press counts.");
+    Serial.print("Deferred log call: ");
+    Serial.print(DeferredLogPrinter::measure());
+    Serial.println(" ns");
+
+    PlotBool::addToPlot(captureChannels, "L.clock", leftClockLevel);
+    PlotBool::addToPlot(captureChannels, "L.data", leftDataLevel);
+    PlotNum<int>::addToPlot(captureChannels, "L.value", leftEncoderValue);
+    capture.capture("L.clock");
+    capture.capture("L.data");
+    capture.capture("L.value");
+    armCapture();
 
     schedule.begin();
 }
@@ -26,10 +26,21 @@ SOFTWARE.
 
 #include <Scheduler.hpp>
 #include <Clock.hpp>
-#include <Graphics.hpp>
+#include <Sprite.hpp>
 #include "Paddle.hpp"
 
-class Ball : public Drawable, private Scheduled {
+// Pre-packed for PageFrame: a column per byte, bit 0 at the top.
+const uint8_t PongBall[] PROGMEM = { 0x0E, 0x1F, 0x1F, 0x1F, 0x0E };
+// 5x7 digits from the Adafruit GFX font.
+const uint8_t PongDigits[10][5] PROGMEM = {
+  { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 },
+  { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 },
+  { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 },
+  { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 },
+  { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }
+};
+
+class Ball : public Drawable<Adafruit_SSD1306>, private Scheduled {
   int16_t _x;
   int16_t _y;
   int16_t _radius;
@@ -43,10 +54,12 @@ class Ball : public Drawable, private Scheduled {
   int16_t _score2;
   Paddle &_player1;
   Paddle &_player2;
+  int16_t _drawnX;
+  int16_t _drawnY;
 public:
-  Ball(Schedule &schedule, MainWindow &window, Paddle &player1, Paddle &player2, int16_t width, int16_t height) :
+  Ball(Schedule &schedule, MainWindow<Adafruit_SSD1306> &window, Paddle &player1, Paddle &player2, int16_t width, int16_t height) :
     Scheduled(schedule), _x(width >> 1), _y(height >> 1), _width(width), _height(height),
-    _player1(player1), _player2(player2), _radius(2), _dx(3), _dy(2), _dt(100) {
+    _player1(player1), _player2(player2), _radius(2), _dx(3), _dy(2), _dt(100), _drawnX(-1), _drawnY(-1) {
       window.add(this);
       _timer.reset(_dt);
       newgame();
@@ -66,16 +79,18 @@ public:
     _x = _width >> 1;
     _y = _height >> 1;
   }
-  void draw(Adafruit_GFX &display) {
-    display.fillCircle(_x, _y, _radius, SSD1306_WHITE);
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    int16_t q = _width >> 2;
-    display.setCursor(q, 0);
-    display.print(_score1, DEC);
-    display.setCursor(3*q, 0);
-    display.print(_score2, DEC);
+  void draw(Adafruit_SSD1306 &display) {
+    PageFrame::of(display).blit(Sprite(5, 5, PongBall, true), _x - _radius, _y - _radius);
+    _drawnX = _x;
+    _drawnY = _y;
   }
+  bool bounds(Rect<int16_t> &rect) {
+    rect = Rect<int16_t>(_x - _radius, _y - _radius, 2 * _radius + 1, 2 * _radius + 1);
+    return true;
+  }
+  bool changed() { return _x != _drawnX || _y != _drawnY; }
+  int16_t score1() const { return _score1; }
+  int16_t score2() const { return _score2; }
   void poll() {
     if (_timer.expired()) {
       _timer.reset(_dt);
@@ -186,4 +201,40 @@ private:
     int r = random(0,100) % 2;
     return r == 0 ? 1 : -1;
   }
-};
\ No newline at end of file
+};
+
+// The scores, kept apart from the ball so they're only resent when they change.
+class Scoreboard : public Drawable<Adafruit_SSD1306> {
+  Ball &_ball;
+  int16_t _width;
+  int16_t _drawn1;
+  int16_t _drawn2;
+public:
+  Scoreboard(MainWindow<Adafruit_SSD1306> &window, Ball &ball, int16_t width) :
+    _ball(ball), _width(width), _drawn1(-1), _drawn2(-1) {
+    window.add(this);
+  }
+  void draw(Adafruit_SSD1306 &display) {
+    PageFrame frame = PageFrame::of(display);
+    int16_t q = _width >> 2;
+    drawNumber(frame, q, _ball.score1());
+    drawNumber(frame, 3 * q, _ball.score2());
+    _drawn1 = _ball.score1();
+    _drawn2 = _ball.score2();
+  }
+  // Room for two 6-pixel digits at each score position.
+  bool bounds(Rect<int16_t> &rect) {
+    int16_t q = _width >> 2;
+    rect = Rect<int16_t>(q, 0, 2 * q + 12, 8);
+    return true;
+  }
+  bool changed() { return _ball.score1() != _drawn1 || _ball.score2() != _drawn2; }
+private:
+  static void drawNumber(PageFrame &frame, int16_t x, int16_t value) {
+    if (value >= 10) {
+      frame.blit(Sprite(5, 8, PongDigits[value / 10 % 10], true), x, 0);
+      x += 6;
+    }
+    frame.blit(Sprite(5, 8, PongDigits[value % 10], true), x, 0);
+  }
+};
@@ -24,22 +24,29 @@ SOFTWARE.
 
 #pragma once
 
-#include <Graphics.hpp>
+#include <Sprite.hpp>
 #include <EncoderWheel.hpp>
 
-class Paddle : public Drawable, private EncoderControl<int16_t> {
+class Paddle : public Drawable<Adafruit_SSD1306>, private EncoderControl<int16_t> {
   int16_t _x;
   int16_t _y;
   int16_t _size;
+  int16_t _drawnY;
 public:
-  Paddle(Schedule &schedule, MainWindow &window, const EncoderConfig &config, int16_t x, int16_t size, int16_t height) :
+  Paddle(Schedule &schedule, MainWindow<Adafruit_SSD1306> &window, const EncoderConfig &config, int16_t x, int16_t size, int16_t height) :
     EncoderControl<int16_t>(schedule, config, _y, (x > 5 ? -5 : 5), height),
-    _x(x), _y(height >> 1), _size(size) {
+    _x(x), _y(height >> 1), _size(size), _drawnY(-1) {
     window.add(this);
   }
-  void draw(Adafruit_GFX &display) {
-    display.drawLine(_x, y0(), _x, y1(), SSD1306_WHITE);
+  void draw(Adafruit_SSD1306 &display) {
+    PageFrame::of(display).fill(Rect<int16_t>(_x, y0(), 1, y1() - y0() + 1));
+    _drawnY = _y;
   }
+  bool bounds(Rect<int16_t> &rect) {
+    rect = Rect<int16_t>(_x, y0(), 1, y1() - y0() + 1);
+    return true;
+  }
+  bool changed() { return _y != _drawnY; }
   int16_t x() const { return _x; }
   int16_t y0() const { return _y - (_size >> 1); }
   int16_t y1() const { return _y + (_size >> 1); }
@@ -51,12 +51,14 @@ SOFTWARE.
 Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
 MainSchedule schedule;
-MainWindow window(schedule, display);
+MainWindow<Adafruit_SSD1306> window(schedule, display);
+SSD1306PageSink<Adafruit_SSD1306> pages(display, SCREEN_ADDRESS);
 
 #define PADDLE_SIZE 10
 Paddle player1(schedule, window, Config.Left.Encoder, 0, PADDLE_SIZE, SCREEN_HEIGHT);
 Paddle player2(schedule, window, Config.Right.Encoder, SCREEN_WIDTH - 1, PADDLE_SIZE, SCREEN_HEIGHT);
 Ball ball(schedule, window, player1, player2, SCREEN_WIDTH, SCREEN_HEIGHT);
+Scoreboard scoreboard(window, ball, SCREEN_WIDTH);
 ButtonHandler newGameButton(schedule, Config.Left.Button, &onNewGamePressed);
 
 void onNewGamePressed() {
@@ -72,6 +74,7 @@ void setup() {
   display.display();
   delay(2000);
   schedule.begin();
+  window.pageSink(pages);
   window.enable(true);
 }
 
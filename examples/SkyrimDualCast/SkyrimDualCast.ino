@@ -93,20 +93,30 @@ LK204_25_Keypad keypad;
 
 static void menuBack(MenuContext &ctx) { ctx.pop(); }
 
-MenuItem timingItems[] = {
-	MenuItem::EditLong("Set up-time", upTime, 25),
-	MenuItem::EditLong("Set down-time", downTime, 25),
-	MenuItem::Action("Back", &menuBack)
+// The menus live in flash; the Leonardo's 2.5KB of SRAM is tight.
+const char lblUpTime[] PROGMEM = "Set up-time";
+const char lblDownTime[] PROGMEM = "Set down-time";
+const char lblBack[] PROGMEM = "Back";
+const char lblTiming[] PROGMEM = "Timing";
+const char lblTimingMenu[] PROGMEM = "Timing...";
+const char lblLeftCast[] PROGMEM = "Toggle left cast";
+const char lblRightCast[] PROGMEM = "Toggle right cast";
+const char lblTitle[] PROGMEM = "Skyrim Dual Cast";
+
+const FlashMenuItem timingItems[] PROGMEM = {
+	MENU_EDIT_LONG_P(lblUpTime, upTime, 25),
+	MENU_EDIT_LONG_P(lblDownTime, downTime, 25),
+	MENU_ACTION_P(lblBack, menuBack)
 };
-MenuScreen timingMenu("Timing", timingItems, (int)(sizeof(timingItems) / sizeof(timingItems[0])));
+FlashMenuScreen timingMenu(lblTiming, timingItems, (uint8_t)(sizeof(timingItems) / sizeof(timingItems[0])));
 
-MenuItem rootItems[] = {
-	MenuItem::Submenu("Timing...", &timingMenu),
-	MenuItem::Toggle("Toggle left cast", leftCasting),
-	MenuItem::Toggle("Toggle right cast", rightCasting),
-	MenuItem::Action("Back", &menuBack)
+const FlashMenuItem rootItems[] PROGMEM = {
+	MENU_SUBMENU_P(lblTimingMenu, timingMenu),
+	MENU_TOGGLE_P(lblLeftCast, leftCastController),
+	MENU_TOGGLE_P(lblRightCast, rightCastController),
+	MENU_ACTION_P(lblBack, menuBack)
 };
-MenuScreen rootMenu("Skyrim Dual Cast", rootItems, (int)(sizeof(rootItems) / sizeof(rootItems[0])));
+FlashMenuScreen rootMenu(lblTitle, rootItems, (uint8_t)(sizeof(rootItems) / sizeof(rootItems[0])));
 
 MenuContext menu(rootMenu);
 MenuRenderer<LK204_25_LCD, 4, 20> menuRenderer(menu);
@@ -0,0 +1,319 @@
+/*
+MIT License
+
+Copyright (c) 2022-2025 jffordem
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+Decodes SerialPlot's binary mode into CSV on a Linux host.
+
+  g++ -O2 -o plotdecode plotdecode.cpp
+  ./plotdecode -s /dev/ttyACM0 > capture.csv     # -s sends "BIN" first
+  ./plotdecode < capture.bin                      # or decode a saved stream
+
+The first column is microseconds since the first sample, widened past the
+board's 32-bit wrap; then one column per channel, named as the board named
+them.  A new column header line is printed whenever the board's channel set
+changes.  Frame counts and errors go to stderr at the end.
+
+The frame format is described in SerialPlot.hpp.
+*/
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+struct Channel {
+    std::string name;
+    bool isBool;
+    bool operator==(const Channel &other) const { return name == other.name && isBool == other.isBool; }
+};
+
+class Decoder {
+    std::vector<Channel> _channels;
+    std::vector<Channel> _printed; // as of the last column header
+    std::vector<int64_t> _values;
+    size_t _named;
+    bool _synced;
+    uint32_t _lastMicros;
+    uint64_t _time;
+    bool _started;
+public:
+    unsigned long frames, badFrames, unsynced, samples;
+
+    Decoder() : _named(0), _synced(false), _lastMicros(0), _time(0), _started(false),
+        frames(0), badFrames(0), unsynced(0), samples(0) { }
+
+    // One frame, COBS encoded, without the 0 delimiter.
+    void frame(const uint8_t *in, size_t n) {
+        std::vector<uint8_t> out;
+        size_t i = 0;
+        while (i < n) {
+            uint8_t code = in[i++];
+            if (code == 0 || i + code - 1 > n) {
+                lost();
+                return;
+            }
+            out.insert(out.end(), in + i, in + i + code - 1);
+            i += code - 1;
+            if (code != 0xFF && i < n) {
+                out.push_back(0);
+            }
+        }
+        if (out.size() < 2 || crc8(out.data(), out.size() - 1) != out.back()) {
+            lost();
+            return;
+        }
+        frames++;
+        out.pop_back();
+        body(out);
+    }
+
+    // A frame went missing, so deltas can't be applied until the next 'K'.
+    void lost() {
+        badFrames++;
+        _synced = false;
+    }
+
+private:
+    static uint8_t crc8(const uint8_t *data, size_t length) {
+        uint8_t crc = 0;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++) {
+                crc = crc & 0x80 ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    struct Reader {
+        const std::vector<uint8_t> &data;
+        size_t pos;
+        bool ok;
+        Reader(const std::vector<uint8_t> &d) : data(d), pos(1), ok(true) { }
+        uint8_t byte() {
+            if (pos >= data.size()) {
+                ok = false;
+                return 0;
+            }
+            return data[pos++];
+        }
+        uint32_t uint32() {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++) v |= (uint32_t)byte() << (8 * i);
+            return v;
+        }
+        uint32_t varint() {
+            uint32_t v = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                uint8_t b = byte();
+                v |= (uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80)) break;
+            }
+            return v;
+        }
+        int32_t zigzag() {
+            uint32_t v = varint();
+            return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+        }
+    };
+
+    void body(const std::vector<uint8_t> &data) {
+        Reader r(data);
+        switch (data[0]) {
+            case 'H':
+                _channels.assign(r.byte(), Channel());
+                _values.assign(_channels.size(), 0);
+                _named = 0;
+                _synced = false;
+                break;
+            case 'N': {
+                size_t id = r.byte();
+                bool isBool = r.byte() == 0;
+                if (id >= _channels.size()) break;
+                std::string name;
+                while (r.pos < data.size() && data[r.pos]) name += (char)data[r.pos++];
+                _channels[id].name = name;
+                _channels[id].isBool = isBool;
+                if (++_named == _channels.size()) printHeader();
+                break;
+            }
+            case 'K': {
+                if (_named < _channels.size() || _channels.empty()) {
+                    unsynced++;
+                    break;
+                }
+                uint32_t micros = r.uint32();
+                std::vector<int64_t> values(_channels.size());
+                for (size_t i = 0; i < values.size(); i++) values[i] = r.zigzag();
+                if (!r.ok) {
+                    lost();
+                    break;
+                }
+                advance(micros - _lastMicros);
+                _lastMicros = micros;
+                _values = values;
+                _synced = true;
+                printSample();
+                break;
+            }
+            case 'D': {
+                if (!_synced) {
+                    unsynced++;
+                    break;
+                }
+                uint32_t dt = r.varint();
+                std::vector<int64_t> values = _values;
+                // The board's longs are 32 bits and its deltas wrap with them.
+                for (size_t i = 0; i < values.size(); i++) values[i] = (int32_t)((uint32_t)values[i] + (uint32_t)r.zigzag());
+                if (!r.ok) {
+                    lost();
+                    break;
+                }
+                advance(dt);
+                _lastMicros += dt;
+                _values = values;
+                printSample();
+                break;
+            }
+            default:
+                lost();
+                break;
+        }
+    }
+
+    void advance(uint32_t dt) {
+        if (_started) {
+            _time += dt;
+        }
+        _started = true;
+    }
+
+    // The board repeats its header for late receivers; only a different
+    // channel set gets a new line of column names.
+    void printHeader() {
+        if (_channels == _printed) return;
+        _printed = _channels;
+        printf("time_us");
+        for (const Channel &c : _channels) printf(",%s", c.name.c_str());
+        printf("\n");
+    }
+
+    void printSample() {
+        samples++;
+        printf("%llu", (unsigned long long)_time);
+        for (size_t i = 0; i < _values.size(); i++) {
+            if (_channels[i].isBool) {
+                printf(",%d", _values[i] ? 1 : 0);
+            } else {
+                printf(",%lld", (long long)_values[i]);
+            }
+        }
+        printf("\n");
+    }
+};
+
+static speed_t baudConstant(long baud) {
+    switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+        default: return B115200;
+    }
+}
+
+static int openSerial(const char *path, long baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        exit(1);
+    }
+    termios tio;
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, baudConstant(baud));
+    cfsetospeed(&tio, baudConstant(baud));
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+    return fd;
+}
+
+int main(int argc, char **argv) {
+    long baud = 115200;
+    bool start = false;
+    const char *device = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+            baud = atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-s")) {
+            start = true;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [-b baud] [-s] [device]\n", argv[0]);
+            return 2;
+        } else {
+            device = argv[i];
+        }
+    }
+    int fd = device ? openSerial(device, baud) : 0;
+    if (device && start) {
+        // Wait out a board reset on open before asking for binary mode.
+        sleep(2);
+        if (write(fd, "BIN\n", 4) != 4) perror("write");
+    }
+
+    Decoder decoder;
+    std::vector<uint8_t> pending;
+    uint8_t buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i]) {
+                pending.push_back(buf[i]);
+                if (pending.size() > 1024) { // not a frame; resync
+                    pending.clear();
+                    decoder.lost();
+                }
+            } else {
+                if (!pending.empty()) decoder.frame(pending.data(), pending.size());
+                pending.clear();
+            }
+        }
+        fflush(stdout);
+    }
+    fprintf(stderr, "%lu frames, %lu samples, %lu bad, %lu before sync\n",
+        decoder.frames, decoder.samples, decoder.badFrames, decoder.unsynced);
+    return 0;
+}